@@ -83,6 +83,12 @@ nsimu_lognormal=2000
 nsimu_bao_detection=50000  
 
 
+;;;;; base seed of rmk_catalogue: each data and random catalogue
+;;;;; gets its own seed seed_rmk+2*(i*nsimu_lognormal+j) (+1 for the
+;;;;; random catalogue) so that their selections are independent
+seed_rmk=1L
+
+
 ;;;;; template used to open raw catalogues after the lognormal program has run
 my_t=ascii_template('../output_files/lognormal/get_template.dat') ;save template of simus
 save,/all,filename='BAOlab.sav'
@@ -135,21 +141,25 @@ for i=0,no1-1 do begin $
 
 ;;;;; Postprocess the catalogues and create the alpha belonging of
 ;;;;; each galaxy in the catalogue, before computing the
-;;;;; alpha-dependent correlation with the program cf_alpha
+;;;;; alpha-dependent correlation with the program cf_alpha.
+;;;;; The program rmk_catalogue does the same as the idl procedure
+;;;;; rmk_catalogue.pro (which can still be used with
+;;;;; data=read_ascii(name,template=my_t) and
+;;;;; rmk_catalogue,data,name_out,name_out_alpha), the selection and
+;;;;; alpha table are set in ../param/rmk_catalogue.param
 
 for i=0,no1-1 do begin $
 &  for j=0L,nsimu_lognormal-1 do begin $
 &   name=lognormal_folder+'DR7-no_'+STRTRIM(i,2)+'-'+STRTRIM(j,2)+'_raw.dat' $
-&   data=read_ascii(name,template=my_t) $
 &   name_out=lognormal_folder+'DR7-no_'+STRTRIM(i,2)+'-'+STRTRIM(j,2)+'.dat' $
 &   name_out_alpha=lognormal_folder+'DR7-no_'+STRTRIM(i,2)+'-'+STRTRIM(j,2)+'_alpha.dat' $
-&   rmk_catalogue,data,name_out,name_out_alpha $ 
+&   seed=seed_rmk+2L*(i*nsimu_lognormal+j) $
+&   spawn,program_folder+'rmk_catalogue -I '+STRTRIM(seed,2)+' '+name+' '+name_out+' '+name_out_alpha $ 
 &   spawn,'rm '+name $
 &   name=lognormal_folder+'DR7-no_'+STRTRIM(i,2)+'-'+STRTRIM(j,2)+'_random_raw.dat' $
-&   data=read_ascii(name,template=my_t) $
 &   name_out=lognormal_folder+'DR7-no_'+STRTRIM(i,2)+'-'+STRTRIM(j,2)+'_random.dat' $
 &   name_out_alpha=lognormal_folder+'DR7-no_'+STRTRIM(i,2)+'-'+STRTRIM(j,2)+'_random_alpha.dat' $
-&   rmk_catalogue,data,name_out,name_out_alpha $ 
+&   spawn,program_folder+'rmk_catalogue -I '+STRTRIM(seed+1,2)+' '+name+' '+name_out+' '+name_out_alpha $ 
 &   spawn,'rm '+name $
 &  endfor $
 & endfor
@@ -178,17 +188,36 @@ for i=0,no1-1 do begin $
 & endfor
 
 
-;;;;; Compute the model-dependent covariance matrix
+;;;;; The three previous steps (lognormal, rmk_catalogue and cf_alpha)
+;;;;; can also be done in a single call of lognormal_cf_alpha, which
+;;;;; keeps the catalogues in memory and only writes the cf_alpha file:
+;;;;;
+;;;;; for i=0,no1-1 do begin $
+;;;;; &  spawn,program_folder+'lognormal_cf_alpha -v -d 800 -m 0 -M 300 -n '+STRTRIM(nsimu_lognormal,2)+' '+ps_folder+'input_pk'+STRTRIM(i,2)+'.dat '+'DR7-no_'+STRTRIM(i,2)+'.fits' $
+;;;;; & endfor
+;;;;;
+;;;;; (the realisations are then named DR7-no_i_j.fits instead of DR7-no_i-j.fits)
+
+
+;;;;; Compute the model-dependent covariance matrix with the program
+;;;;; mk_covmatrix (C++ version of the idl procedure
+;;;;; mk_covmatrix,name_prefix,name_cov_no). The bins rout, the number
+;;;;; of Omega_m h^2 values and of simulations are set in
+;;;;; ../param/mk_covmatrix.param. Add the option -S _ for the outputs
+;;;;; of lognormal_cf_alpha.
 
 name_prefix=cf_alpha_folder+'DR7-no_'
 name_cov_no=simu_folder+'cov_all_no.fits'
-mk_covmatrix,name_prefix,name_cov_no
+spawn,program_folder+'mk_covmatrix -v '+name_prefix+' '+name_cov_no
 
 
 ;;;;; Transform the model-dependent covariance matrix: compute the square root, the inverse
 ;;;;; and the determinant of the model-dependent cov matrix (required for the BAO detection)
+;;;;; with the program transform_covmatrix (C++ version of the idl procedure
+;;;;; transform_covmatrix,name_cov_no). The output names are set in
+;;;;; ../param/transform_covmatrix.param
 
-transform_covmatrix,name_cov_no
+spawn,program_folder+'transform_covmatrix -v '+name_cov_no
 
 
 ;;;;; Create the model correlation functions with BAOs (for parameter
@@ -204,7 +233,11 @@ icosmoPS_grid
 ;;;;; and alpha
 
 name_xi=simu_folder+'dr7.fits'
-likelihood,name_xi
+spawn,program_folder+'likelihood -v '+name_xi
+spawn,program_folder+'likelihood -v -c '+name_xi
+
+;;;;; Same with the idl procedure (slower), which also plots the contours
+;;;;; likelihood,name_xi
 
 
 ;;;;; Create histograms for the BAO detection, using either the Delta
@@ -213,12 +246,18 @@ likelihood,name_xi
 ;;;;; (for this, just add the option -c), and using either the H0
 ;;;;; hypothesis or the H1 hypothesis.
 
-spawn,program_folder+'delta_chi2 -v -h 0'
-spawn,program_folder+'delta_chi2 -v -h 1'
-spawn,program_folder+'delta_chi2 -v -h 0 -c'
-spawn,program_folder+'delta_chi2 -v -h 1 -c'
-spawn,program_folder+'lratio -v -h 0 -c'
-spawn,program_folder+'lratio -v -h 1 -c'
+spawn,program_folder+'bao_detection -v -h 0'
+spawn,program_folder+'bao_detection -v -h 1'
+
+;;;;; bao_detection writes in a single pass the outputs of the six runs
+;;;;; below (the simulations are drawn once for the three statistics)
+
+;spawn,program_folder+'delta_chi2 -v -h 0'
+;spawn,program_folder+'delta_chi2 -v -h 1'
+;spawn,program_folder+'delta_chi2 -v -h 0 -c'
+;spawn,program_folder+'delta_chi2 -v -h 1 -c'
+;spawn,program_folder+'lratio -v -h 0 -c'
+;spawn,program_folder+'lratio -v -h 1 -c'
 
 
 ;;;;; Compute the mean significance of the BAO detection under H1, with the
@@ -227,6 +266,11 @@ spawn,program_folder+'lratio -v -h 1 -c'
 ;;;;; (lratio=1), and using either a constant cov matrix (varcov=0) or
 ;;;;; model-dependent cov matrix (varcov=1)
 
-sign_bao_detection,lratio=0,varcov=0
-sign_bao_detection,lratio=0,varcov=1
-sign_bao_detection,lratio=1,varcov=1
+spawn,program_folder+'bao_significance'
+spawn,program_folder+'bao_significance -c'
+spawn,program_folder+'bao_significance -l -c'
+
+;;;;; Same with the idl procedure (slower)
+;;;;; sign_bao_detection,lratio=0,varcov=0
+;;;;; sign_bao_detection,lratio=0,varcov=1
+;;;;; sign_bao_detection,lratio=1,varcov=1
@@ -0,0 +1,668 @@
+/*******************************************************
+Program: 'bao_detection.cc'
+
+Simulations of the BAO detection for the three statistics used by
+idl/script.pro in a single pass: the Delta chi^2 with the constant
+covariance matrix ('delta_chi2'), the Delta chi^2 with the
+model-dependent covariance matrix ('delta_chi2 -c') and the
+generalized likelihood ratio with the model-dependent covariance
+matrix ('lratio -c'), under the hypothesis H0 or H1 (-h).
+
+For each simulation the Gaussian vector g is drawn once and gives
+  xi   = B xi_m + sqrt(C) g               (constant covariance)
+  xi_c = B (xi_m + sqrt(C_m) g)           (model-dependent covariance)
+the Delta chi^2 of xi and xi_c both use the whitened models of the
+fitting grid (one bank for the two statistics), and the likelihood
+ratio of xi_c the products iC_m#xi_c over the models of its grid.
+The streams are those of 'delta_chi2' and 'lratio', so with the same
+seed the three outputs are the ones of the separate programs.
+
+The parameters are read in ../param/delta_chi2.param (hypothesis and
+fitting grids, models, n_simu, histograms) and ../param/lratio.param
+(model-dependent inverse covariance matrices and log-determinants),
+which must have the same hypothesis grid, models, covariance matrices
+and n_simu. The outputs are written with the names and in the output
+folders of 'delta_chi2' and 'lratio', and have the options -H,
+--shard and -R of these programs (the adaptive mode -a and the
+importance sampling -S, which depend on the statistic, are only in
+'delta_chi2' and 'lratio').
+
+Version history:
+
+  V. 0.1 (19/10/2026): Initial version.
+********************************************************/
+
+#include "Array.h"
+#include "IM_IO.h"
+#include "bao_tools.h"
+#include "RandStream.h"
+#include <omp.h>
+
+#define NSTAT 3             //statistics of a pass
+#define STAT_DCHI2 0        //Delta chi^2, constant covariance matrix
+#define STAT_DCHI2_VARCOV 1 //Delta chi^2, model-dependent covariance matrix
+#define STAT_LRATIO 2       //likelihood ratio, model-dependent covariance matrix
+
+
+int h=0;
+Bool Verbose=False;
+
+// (TO BE SET IN DELTA_CHI2.PARAM FILE)
+double o_min1,o_max1,delta_o,o_min2,o_max2;				//Omega_m h^2
+double a_min1,a_max1,delta_a,a_min2,a_max2;				//alpha
+double B_min1,B_max1,delta_B,B_min2,B_max2,B_model;		//B
+
+char Name_o_table[256]; char Name_a_table[256]; char Name_B_table[256];
+
+char Name_Inverse_Cov[256];     //name for inverse convariance matrix
+char Name_Sqrt_Cov[256];        //name for square root convariance matrix
+char Name_Sqrt_Cov_all[256];        //name for square root model-dependent covariance matrix
+char Name_Model_BAO_all[256];   //name for BAO model correlations
+char Name_Model_noBAO_all[256]; //name for noBAO model correlations
+double n_simu;
+
+char Name_Histo_Out_Prefix[256];		/* output file prefix name */
+
+// (TO BE SET IN LRATIO.PARAM FILE)
+char Name_Inverse_Cov_all[256];     //name for inverse model-dependent covariance matrix
+char Name_Log_Determ_Cov_all[256];   //name for log of determinant model-dependent covariance matrix
+char Name_Lratio_Out_Prefix[256];	/* output file prefix name of the likelihood ratio */
+
+Bool Histo=False;    //streaming histograms instead of the statistic of every simulation (-H)
+double Histo_Min,Histo_Max,Histo_Bin;    //range and bin size of the streaming histograms
+Bool Histo_Param=False;
+Bool Resume=False;   //start from the checkpoint of an interrupted run (-R)
+int Shard=0, NShard=1;   //points j of the grid with j%NShard==Shard (--shard)
+long seed;    //seed of the random streams
+
+//maximum number of procs used for the loops
+int Nproc_max=40;
+
+
+static void usage(char *argv[])
+{
+    fprintf(OUTMAN, "Usage: %s options \n\n", argv[0]);
+    fprintf(OUTMAN, "   where options =  \n");
+
+    fprintf(OUTMAN, "         [-h h_value]\n");
+    fprintf(OUTMAN, "             Hypothesis sampled (h=0 for noBAO, h=1 for BAO).\n");
+    fprintf(OUTMAN, "             Default is 0.");
+    manline();
+
+	fprintf(OUTMAN, "         [-H ]\n");
+    fprintf(OUTMAN, "             Write for each point of the grid the histograms of the statistics\n");
+    fprintf(OUTMAN, "             (range and bin size in delta_chi2.param) instead of all their values.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-R] or [--resume]\n");
+    fprintf(OUTMAN, "             Start from the checkpoint written by an interrupted run with the\n");
+    fprintf(OUTMAN, "             same options (its seed is used), the outputs are the same as without\n");
+    fprintf(OUTMAN, "             interruption.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [--shard k/K]\n");
+    fprintf(OUTMAN, "             Only the points j of the hypothesis grid with j%%K=k (0<=k<K), written\n");
+    fprintf(OUTMAN, "             in partial outputs '_shard<k>' merged by 'merge_shards'.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-I InitRandomVal]\n");
+    fprintf(OUTMAN, "             Value used for random value generator initialization.\n");
+	manline();
+
+
+    vm_usage();
+    manline();
+    verbose_usage();
+    manline();
+    manline();
+    exit(-1);
+}
+
+/*********************************************************************/
+
+/* GET PARAMETERS */
+
+void get_param()
+{
+	char Name_Param_File[256];
+	sprintf(Name_Param_File, "../param/delta_chi2.param");
+	FILE *File=fopen(Name_Param_File,"r");
+
+    if (File == NULL)
+    {
+		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
+		exit(-1);
+    }
+	char Temp[256];
+	int ret;
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &o_min1, &o_max1, &delta_o);	//min, max, step in Omega_m h^2 for hypotheses
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &a_min1, &a_max1, &delta_a);	//min, max, step in alpha for hypotheses
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &B_min1, &B_max1, &delta_B);	//min, max, step in B for hypotheses
+	ret=fscanf(File, "%s\t%lf\t%lf\n", Temp, &o_min2, &o_max2);					//min, max, in Omega_m h^2 for fitting
+	ret=fscanf(File, "%s\t%lf\t%lf\n", Temp, &a_min2, &a_max2);					//min, max, in alpha for fitting
+	ret=fscanf(File, "%s\t%lf\t%lf\n", Temp, &B_min2, &B_max2);					//min, max, in B for fitting
+	ret=fscanf(File, "%s\t%lf\n\n", Temp, &B_model);								//B model
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_a_table);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_o_table);
+	ret=fscanf(File, "%s\t%s\n\n", Temp, Name_B_table);
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Model_BAO_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Model_noBAO_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Sqrt_Cov_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Inverse_Cov);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Sqrt_Cov);
+	ret=fscanf(File, "%s\t%lf\n\n", Temp, &n_simu);
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Histo_Out_Prefix);
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &Histo_Min, &Histo_Max, &Histo_Bin);	//min, max, bin size of the streaming histograms (optional)
+	if(ret==4) Histo_Param=True;
+
+	fclose(File);
+}
+
+//The parameters of lratio.param, which must be the ones of delta_chi2.param for the common part
+void get_param_lratio()
+{
+	char Name_Param_File[256];
+	sprintf(Name_Param_File, "../param/lratio.param");
+	FILE *File=fopen(Name_Param_File,"r");
+
+    if (File == NULL)
+    {
+		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
+		exit(-1);
+    }
+	char Temp[256];
+	double o_min,o_max,delta_o_l,a_min,a_max,delta_a_l,B_min,B_max,delta_B_l,B_model_l,n_simu_l;
+	char Name_a[256], Name_o[256], Name_B[256], Name_BAO[256], Name_noBAO[256];
+	char Name_Sqrt_all[256], Name_Inverse[256], Name_Sqrt[256];
+	int ret;
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &o_min, &o_max, &delta_o_l);	//min, max, step in Omega_m h^2
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &a_min, &a_max, &delta_a_l);	//min, max, step in alpha
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &B_min, &B_max, &delta_B_l);	//min, max, step in B
+	ret=fscanf(File, "%s\t%lf\n\n", Temp, &B_model_l);								//B model
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_a);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_o);
+	ret=fscanf(File, "%s\t%s\n\n", Temp, Name_B);
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_BAO);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_noBAO);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Inverse_Cov_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Sqrt_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Log_Determ_Cov_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Inverse);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Sqrt);
+	ret=fscanf(File, "%s\t%lf\n\n", Temp, &n_simu_l);
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Lratio_Out_Prefix);
+
+	fclose(File);
+
+	if(o_min!=o_min1 || o_max!=o_max1 || delta_o_l!=delta_o || a_min!=a_min1 || a_max!=a_max1 || delta_a_l!=delta_a || \
+	   B_min!=B_min1 || B_max!=B_max1 || delta_B_l!=delta_B || B_model_l!=B_model || n_simu_l!=n_simu || \
+	   strcmp(Name_a, Name_a_table)!=0 || strcmp(Name_o, Name_o_table)!=0 || strcmp(Name_B, Name_B_table)!=0 || \
+	   strcmp(Name_BAO, Name_Model_BAO_all)!=0 || strcmp(Name_noBAO, Name_Model_noBAO_all)!=0 || \
+	   strcmp(Name_Sqrt_all, Name_Sqrt_Cov_all)!=0 || strcmp(Name_Inverse, Name_Inverse_Cov)!=0 || strcmp(Name_Sqrt, Name_Sqrt_Cov)!=0)
+	{
+		fprintf(OUTMAN,"delta_chi2.param and lratio.param must have the same hypothesis grid, models, covariance matrices and n_simu.\n");
+		exit(-1);
+	}
+}
+
+
+/*********************************************************************/
+
+/* GET COMMAND LINE ARGUMENTS */
+static void filtinit(int argc, char *argv[])
+{
+	int i=1;
+	while(i<argc)
+	{
+		if(argv[i][0] != '-' ) break;
+
+		switch (argv[i][1])
+        {
+			case 'h':
+				if(i+1==argc)
+				{
+					fprintf(OUTMAN, "Error: no argument for -h.\n"); exit(-1);
+				}
+				h=atoi(argv[++i]);
+				if(strcmp(argv[i],"0")!=0 && strcmp(argv[i],"1")!=0)
+					{
+						fprintf(OUTMAN, "Error: bad number value for h: %s\n",argv[i] );
+						exit(-1);
+					}
+					break;
+			case 'H': Histo = True;break;
+			case 'I':
+				if(i+1==argc)
+				{
+					fprintf(OUTMAN, "Error: no argument for -I.\n"); exit(-1);
+				}
+				seed=atol(argv[++i]);
+				break;
+			case 'R': Resume = True;break;
+			case '-':
+				if(strcmp(argv[i],"--resume")==0) Resume = True;
+				else if(strcmp(argv[i],"--shard")==0)
+				{
+					if(i+1==argc)
+					{
+						fprintf(OUTMAN, "Error: no argument for --shard.\n"); exit(-1);
+					}
+					if(sscanf(argv[++i], "%d/%d", &Shard, &NShard)!=2 || NShard<1 || Shard<0 || Shard>=NShard)
+					{
+						fprintf(OUTMAN, "Error: bad value for --shard: %s\n",argv[i]); exit(-1);
+					}
+				}
+				else usage(argv);
+				break;
+			case 'v': Verbose = True;break;
+			case '?': usage(argv); break;
+			default: usage(argv); break;
+			}
+		i++;
+	}
+
+
+	/* make sure there are not too many parameters */
+	if (i < argc)
+        {
+		fprintf(OUTMAN, "Too many parameters: %s ...\n", argv[i]);
+		exit(-1);
+	}
+
+
+}
+
+
+/***************/
+
+
+int main(int argc, char *argv[])
+{
+	/* Random init (changed with -I) */
+	seed = time(NULL);
+
+     /* Get command line arguments, open input file(s) if necessary */
+    filtinit(argc, argv);
+
+	/* Get parameters */
+	get_param();
+	get_param_lratio();
+
+	if(o_min1 > o_max1 || a_min1>a_max1 || B_min1 >B_max1 || o_min2 > o_max2 || a_min2>a_max2 || B_min2 >B_max2 )
+	{
+		fprintf(OUTMAN,"minimum values of parameters must be less than maximum values.\n");
+		exit(-1);
+	}
+
+
+	//Names, the ones of delta_chi2, delta_chi2 -c and lratio -c
+	char Name_Histo_Out[NSTAT][256];
+	sprintf(Name_Histo_Out[STAT_DCHI2], "%sDchi2_h%d.fits", Name_Histo_Out_Prefix, h);
+	sprintf(Name_Histo_Out[STAT_DCHI2_VARCOV], "%sDchi2_varcov_h%d.fits", Name_Histo_Out_Prefix, h);
+	sprintf(Name_Histo_Out[STAT_LRATIO], "%slratio_varcov_h%d.fits", Name_Lratio_Out_Prefix, h);
+	char Name_Ckpt[256];            //name of the checkpoint (followed by .ckpt)
+	sprintf(Name_Ckpt, "%sbao_detection_h%d.fits", Name_Histo_Out_Prefix, h);
+	if(Histo==True)
+	{
+		if(Histo_Param==False || Histo_Bin<=0 || Histo_Max<=Histo_Min)
+		{
+			fprintf(OUTMAN,"-H needs a line Histo(min,max,binsize) with min<max and binsize>0 at the end of the param file.\n");
+			exit(-1);
+		}
+		for(int s=0;s<NSTAT;s++) strcpy(Name_Histo_Out[s]+strlen(Name_Histo_Out[s])-5, "_histo.fits");
+		strcpy(Name_Ckpt+strlen(Name_Ckpt)-5, "_histo.fits");
+	}
+	if(NShard>1)
+	{
+		for(int s=0;s<NSTAT;s++) sprintf(Name_Histo_Out[s]+strlen(Name_Histo_Out[s])-5, "_shard%d.fits", Shard);
+		sprintf(Name_Ckpt+strlen(Name_Ckpt)-5, "_shard%d.fits", Shard);
+	}
+
+
+	//Read arrays
+	fltarray iC,sC,iC_all,sC_all,Log_DetermC_all,model_BAO_all, model_noBAO_all;
+	fits_read_fltarr(Name_Sqrt_Cov_all, sC_all);
+	fits_read_fltarr(Name_Inverse_Cov_all, iC_all);
+	fits_read_fltarr(Name_Log_Determ_Cov_all, Log_DetermC_all);
+	fits_read_fltarr(Name_Inverse_Cov, iC);
+	fits_read_fltarr(Name_Sqrt_Cov, sC);
+	fits_read_fltarr(Name_Model_BAO_all, model_BAO_all);
+	fits_read_fltarr(Name_Model_noBAO_all, model_noBAO_all);
+
+
+	int nr=model_BAO_all.nz();
+	if(nr != model_noBAO_all.nz())
+	{
+		fprintf(OUTMAN,"Incompatible dimensions between models.\n");
+		exit(-1);
+	}
+	if(nr != iC.nx() || nr != iC.ny())
+	{
+		fprintf(OUTMAN,"Incompatible dimensions between models and covariance matrix.\n");
+		exit(-1);
+	}
+
+	//read parameter table
+	fltarray o_table,a_table,B_table;
+	fits_read_fltarr(Name_o_table, o_table); fits_read_fltarr(Name_a_table, a_table); fits_read_fltarr(Name_B_table, B_table);
+
+	int no_table=o_table.nx(); 	int na_table=a_table.nx(); 	int nB_table=B_table.nx();
+	if(no_table != model_BAO_all.nx() || no_table != model_noBAO_all.nx() ||  \
+	   na_table != model_BAO_all.ny() || na_table != model_noBAO_all.ny())
+	{
+		cout <<"Incompatible dimensions between models and parameter tables" << endl;
+		exit(-1);
+	}
+	double delta_o_table=o_table(1)-o_table(0); double delta_a_table=a_table(1)-a_table(0); double delta_B_table=B_table(1)-B_table(0);
+
+
+	//Find indices for hypotheses model correlations according to requested limits
+	int oind_min1,oind_max1,aind_min1,aind_max1,Bind_min1,Bind_max1;
+	int delta_oind,delta_aind,delta_Bind;
+	delta_oind=round(delta_o/delta_o_table); delta_aind=round(delta_a/delta_a_table); delta_Bind=round(delta_B/delta_B_table);
+
+ 	//readjust delta parameters
+	delta_o=delta_oind*delta_o_table; delta_a=delta_aind*delta_a_table; delta_B=delta_Bind*delta_B_table;
+
+	oind_min1=round((o_min1-o_table.min())/(delta_o_table)); oind_max1=round((o_max1-o_table.min())/delta_o_table);
+	aind_min1=round((a_min1-a_table.min())/(delta_a_table)); aind_max1=round((a_max1-a_table.min())/delta_a_table);
+	Bind_min1=round((B_min1-B_table.min())/(delta_B_table)); Bind_max1=round((B_max1-B_table.min())/delta_B_table);
+	if(oind_min1<0 || oind_min1 >=no_table || oind_max1<0 || oind_max1 >=no_table || \
+	   aind_min1<0 || aind_min1 >=na_table || aind_max1<0 || aind_max1 >=na_table || \
+	   Bind_min1<0 || Bind_min1 >=nB_table || Bind_max1<0 || Bind_max1 >=nB_table)
+	{
+		cout << "Hypotheses range out of limits" << endl; exit(-1);
+	}
+	if(delta_oind<1 || delta_aind<1 || delta_Bind<1)
+	{
+		cout << "Too small binning of the parameters (smaller than the model grid)" << endl; exit(-1);
+	}
+	oind_min1=round(double(oind_min1)/double(delta_oind)); oind_max1=round(double(oind_max1)/double(delta_oind));
+	aind_min1=round(double(aind_min1)/double(delta_aind)); aind_max1=round(double(aind_max1)/double(delta_aind));
+	Bind_min1=round(double(Bind_min1)/double(delta_Bind)); Bind_max1=round(double(Bind_max1)/double(delta_Bind));
+	int nind_o1=oind_max1-oind_min1+1; 	int nind_a1=aind_max1-aind_min1+1; 	int nind_B1=Bind_max1-Bind_min1+1;
+
+	//Readjust parameter limits
+	o_min1=o_table(oind_min1*delta_oind); o_max1=o_table(oind_max1*delta_oind);
+	a_min1=a_table(aind_min1*delta_aind); a_max1=a_table(aind_max1*delta_aind);
+	B_min1=B_table(Bind_min1*delta_Bind); B_max1=B_table(Bind_max1*delta_Bind);
+
+
+
+	//Find indices for model correlation functions to fit according to requested limits
+	int oind_min2,oind_max2,aind_min2,aind_max2;
+
+	oind_min2=round((o_min2-o_table.min())/(delta_o_table)); oind_max2=round((o_max2-o_table.min())/delta_o_table);
+	aind_min2=round((a_min2-a_table.min())/(delta_a_table)); aind_max2=round((a_max2-a_table.min())/delta_a_table);
+	if(oind_min2<0 || oind_min2 >=no_table || oind_max2<0 || oind_max2 >=no_table || \
+	   aind_min2<0 || aind_min2 >=na_table || aind_max2<0 || aind_max2 >=na_table )
+	{
+		cout << "Fitting range out of limits" << endl; exit(-1);
+	}
+	oind_min2=round(double(oind_min2)/double(delta_oind)); oind_max2=round(double(oind_max2)/double(delta_oind));
+	aind_min2=round(double(aind_min2)/double(delta_aind)); aind_max2=round(double(aind_max2)/double(delta_aind));
+
+	//Readjust parameter limitis
+	o_min2=o_table(oind_min2*delta_oind); o_max2=o_table(oind_max2*delta_oind);
+	a_min2=a_table(aind_min2*delta_aind); a_max2=a_table(aind_max2*delta_aind);
+
+
+
+	//Print parameters
+    if (Verbose == True)
+    {
+		cout << endl << endl << "BAO DETECTION (Delta chi2, Delta chi2 and likelihood ratio with non constant covariance matrix)" << endl << endl;
+		if(h==0) cout << "-Sample H0 (noBAO) hypothesis " << endl;
+		if(h==1) cout << "-Sample H1 (BAO) hypothesis " << endl;
+
+		cout << endl << endl << "RANGE FOR HYPOTHESES (and fits of the likelihood ratio): " << endl;
+		cout << "Omega_m h^2 grid used (min,max,delta) = ("<< o_min1 << " , " << o_max1 << " , " << delta_o << ")"<< endl ;
+		cout << "alpha grid used (min,max,delta) = ("<< a_min1 << " , " << a_max1 << " , " << delta_a << ")"<< endl;
+		cout << "B (min,max,delta) used (min,max,delta) = ("<< B_min1 << " , " << B_max1 << " , " << delta_B << ")"<< endl << endl;
+
+		cout << endl << endl << "FITTING RANGE OF DELTA CHI2: " << endl;
+		cout << "Omega_m h^2 grid used (min,max,delta) = ("<< o_min2 << " , " << o_max2 << " , " << delta_o << ")"<< endl ;
+		cout << "alpha grid used (min,max,delta) = ("<< a_min2 << " , " << a_max2 << " , " << delta_a << ")"<< endl;
+		cout << "B grid used (min,max) = ("<< B_min2 << " , " << B_max2 << ")"<< endl << endl;
+
+		cout << "Number of simulations for each point = " << n_simu << endl << endl;
+
+		for(int s=0;s<NSTAT;s++) cout << "Write histo in file " << Name_Histo_Out[s] << endl;
+		cout << endl << endl;
+    }
+
+	//Whitened models of the fitting grid of the Delta chi2, for both covariance matrices
+	int nind_o2=oind_max2-oind_min2+1; 	int nind_a2=aind_max2-aind_min2+1;
+	ModelBank bank_BAO, bank_noBAO;
+	bank_BAO.alloc(iC, nind_o2*nind_a2);
+	bank_noBAO.alloc(iC, nind_o2*nind_a2);
+	for(int oind2=oind_min2; oind2<=oind_max2; oind2++)
+	{
+		for(int aind2=aind_min2; aind2<=aind_max2; aind2++)
+		{
+			int m=(oind2-oind_min2)*nind_a2+aind2-aind_min2;
+			bank_BAO.set_model(m, model_BAO_all, oind2*delta_oind, aind2*delta_aind);
+			bank_noBAO.set_model(m, model_noBAO_all, oind2*delta_oind, aind2*delta_aind);
+		}
+	}
+	double B_fit_min=B_min2/B_model, B_fit_max=B_max2/B_model;
+
+	//Models of the likelihood ratio, fitted over the hypothesis grid as in lratio
+	int nmodel=nind_o1*nind_a1;
+	double *Model_BAO=new double[nmodel*nr];
+	double *Model_noBAO=new double[nmodel*nr];
+	int *Index_Z=new int[nmodel];
+	double *C_BAO=new double[nmodel];
+	double *C_noBAO=new double[nmodel];
+	for(int oind2=oind_min1; oind2<=oind_max1; oind2++)
+	{
+		for(int aind2=aind_min1; aind2<=aind_max1; aind2++)
+		{
+			int m=(oind2-oind_min1)*nind_a1+aind2-aind_min1;
+			Index_Z[m]=na_table*oind2*delta_oind+aind2*delta_aind;
+			for(int i=0;i<nr;i++) Model_BAO[m*nr+i]=model_BAO_all(oind2*delta_oind,aind2*delta_aind,i);
+			for(int i=0;i<nr;i++) Model_noBAO[m*nr+i]=model_noBAO_all(oind2*delta_oind,aind2*delta_aind,i);
+			const float *inv_cov=iC_all.buffer()+(long) Index_Z[m]*nr*nr;
+			C_BAO[m]=quadratic(nr, inv_cov, Model_BAO+m*nr);
+			C_noBAO[m]=quadratic(nr, inv_cov, Model_noBAO+m*nr);
+		}
+	}
+	double B_lratio_min=B_min1/B_model, B_lratio_max=B_max1/B_model;
+
+	//histograms of the three statistics, with the rows of the points of the shard
+	//(j=Shard+row*NShard, all the points without --shard)
+	int nrow=(nind_o1*nind_a1*nind_B1-Shard+NShard-1)/NShard;
+	if(nrow==0)
+	{
+		fprintf(OUTMAN,"--shard: more shards than points of the grid (%d).\n", nind_o1*nind_a1*nind_B1);
+		exit(-1);
+	}
+	fltarray Stat_Histo[NSTAT];
+	int nbin_histo=0;
+	if(Histo==True) nbin_histo=histo_nbin(Histo_Min, Histo_Max, Histo_Bin);
+	for(int s=0;s<NSTAT;s++)
+	{
+		if(Histo==True) Stat_Histo[s].alloc(nbin_histo+2, nrow);
+		else if(NShard==1) Stat_Histo[s].alloc(nind_o1*nind_a1*nind_B1*n_simu);
+		else Stat_Histo[s].alloc(n_simu, nrow);
+	}
+	long int count=0;
+
+	//state of the loop over the grid (one round) and its checkpoints
+	long *N_Done=new long[nind_o1*nind_a1*nind_B1];
+	long *K_Tail=new long[nind_o1*nind_a1*nind_B1];
+	int *Round=new int[nind_o1*nind_a1*nind_B1];
+	for(int j=0;j<nind_o1*nind_a1*nind_B1;j++) {N_Done[j]=0; K_Tail[j]=0; Round[j]=0;}
+	double p_ref=0.;
+	double Key[]={double(h), double(Histo), n_simu, double(Shard), double(NShard),
+	              o_min1, o_max1, delta_o, a_min1, a_max1, delta_a, B_min1, B_max1, delta_B,
+	              o_min2, o_max2, a_min2, a_max2, B_min2, B_max2, B_model,
+	              Histo_Min, Histo_Max, Histo_Bin};
+	Checkpoint Ckpt;
+	Ckpt.init(Name_Ckpt, Key, sizeof(Key)/sizeof(double), Stat_Histo, NSTAT, nind_o1*nind_a1*nind_B1, N_Done, K_Tail, Round, &p_ref, &seed);
+	if(Resume==True)
+	{
+		if(Ckpt.read())
+		{
+			int nfinished=0;
+			for(int j=Shard;j<nind_o1*nind_a1*nind_B1;j+=NShard) if(Round[j]==1) nfinished++;
+			printf("Resume from %s: %d/%d points finished, seed %ld\n", Ckpt.name(), nfinished, nrow, seed);
+		}
+		else printf("No checkpoint %s, start from the beginning\n", Ckpt.name());
+	}
+
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+		printf("\n %u processors used for the loop \n\n",Nproc);
+	#endif
+
+
+	//Main loop for simu histogram
+    #pragma omp parallel default(shared) num_threads(Nproc)
+    {
+		//Create variables for the loop (no allocation in the loop)
+		double *model0=new double[nr];
+		double *g=new double[nr]; //gaussian standard variable
+		double *y=new double[nr]; //iC#xi of the likelihood ratio
+		RandStream R;             //random stream of the current point of the tables
+		float *Row=new float[NSTAT*(nbin_histo+2)];  //counts of the current point with -H
+
+		//batch of simulations: xi for both covariance matrices, whitened xi, best fits and statistics
+		double *X=new double[SIMU_BATCH*nr];
+		double *X_Var=new double[SIMU_BATCH*nr];
+		double *WX=new double[SIMU_BATCH*nr];
+		double *WX2=new double[SIMU_BATCH];
+		double *Chi2_BAO=new double[SIMU_BATCH];
+		double *Chi2_noBAO=new double[SIMU_BATCH];
+		double *Work=new double[SIMU_BATCH*BANK_BLOCK];
+		double *Stat=new double[NSTAT*SIMU_BATCH];
+
+		#pragma omp for schedule(dynamic)
+		for(int j=0;j<nind_o1*nind_a1*nind_B1;j++)
+		{
+			int oind1=j/(nind_a1*nind_B1)+oind_min1;
+			int temp=j-(oind1-oind_min1)*(nind_a1*nind_B1);
+			int aind1=temp/nind_B1+aind_min1;
+			int Bind1=temp-(aind1-aind_min1)*nind_B1+Bind_min1;
+
+			double B1=B_table(Bind1*delta_Bind)/B_model;
+			int index_z=na_table*oind1*delta_oind+aind1*delta_aind;
+			const float *sqrt_cov=sC.buffer();
+			const float *sqrt_cov_var=sC_all.buffer()+(long) index_z*nr*nr;
+
+			//the streams of delta_chi2 and lratio
+			R.init(seed, ((uint64_t) (oind1*delta_oind)*na_table+aind1*delta_aind)*nB_table+Bind1*delta_Bind);
+
+			progress(&count, nind_o1*nind_a1*nind_B1, Verbose==True);
+			if(j%NShard!=Shard || Round[j]>0) continue;      //other shard, or finished before the checkpoint
+			int row=j/NShard;
+
+			//model for hypothesis H0 or H1
+			if(h==0)
+				for(int i=0;i<nr;i++) model0[i]=model_noBAO_all(oind1*delta_oind,aind1*delta_aind,i);
+			if(h==1)
+				for(int i=0;i<nr;i++) model0[i]=model_BAO_all(oind1*delta_oind,aind1*delta_aind,i);
+
+			for(int i=0;i<NSTAT*(nbin_histo+2);i++) Row[i]=0.;
+			for(long sind0=0; sind0<n_simu; sind0+=SIMU_BATCH)
+			{
+				int nbatch=0;
+				for(long sind=sind0; sind<n_simu && sind<sind0+SIMU_BATCH; sind++, nbatch++)
+				{
+					double *xi=X+nbatch*nr, *xi_var=X_Var+nbatch*nr;
+					R.set_counter((uint64_t) sind*(nr+nr%2)); //each vector uses nr+nr%2 numbers
+					R.gauss(g, nr);
+
+					matvec(nr, sqrt_cov, g, xi);                   //Constant covariance matrix
+					axpy(nr, B1, model0, xi);
+					matvec(nr, sqrt_cov_var, g, xi_var);           //Varying covariance matrix
+					axpy(nr, 1., model0, xi_var); scal(nr, B1, xi_var);
+				}
+
+				//Delta chi2 of both xi with the whitened models
+				bank_BAO.whiten_batch(nbatch, X, WX, WX2);
+				bank_BAO.min_chi2_batch(nbatch, WX, WX2, B_fit_min, B_fit_max, Chi2_BAO, Work);
+				bank_noBAO.min_chi2_batch(nbatch, WX, WX2, B_fit_min, B_fit_max, Chi2_noBAO, Work);
+				for(int sind=0; sind<nbatch; sind++) Stat[STAT_DCHI2*SIMU_BATCH+sind]=Chi2_noBAO[sind]-Chi2_BAO[sind];
+
+				bank_BAO.whiten_batch(nbatch, X_Var, WX, WX2);
+				bank_BAO.min_chi2_batch(nbatch, WX, WX2, B_fit_min, B_fit_max, Chi2_BAO, Work);
+				bank_noBAO.min_chi2_batch(nbatch, WX, WX2, B_fit_min, B_fit_max, Chi2_noBAO, Work);
+				for(int sind=0; sind<nbatch; sind++) Stat[STAT_DCHI2_VARCOV*SIMU_BATCH+sind]=Chi2_noBAO[sind]-Chi2_BAO[sind];
+
+				//likelihood ratio of xi with the varying covariance matrix
+				for(int sind=0; sind<nbatch; sind++)
+				{
+					double *xi=X_Var+sind*nr;
+					double lBAO_min=HUGE_VAL, lnoBAO_min=HUGE_VAL;
+					for(int m=0;m<nmodel;m++)
+					{
+						int index_z2=Index_Z[m];
+						//one product y=iC#xi gives a, and b for both models
+						matvec(nr, iC_all.buffer()+(long) index_z2*nr*nr, xi, y);
+						double a=dot(nr, y, xi);
+
+						double b=dot(nr, y, Model_BAO+m*nr);
+						double l=fit_varcov(nr, a, b, C_BAO[m], Log_DetermC_all(index_z2), B_lratio_min, B_lratio_max);
+						if(l<lBAO_min) lBAO_min=l;
+
+						b=dot(nr, y, Model_noBAO+m*nr);
+						l=fit_varcov(nr, a, b, C_noBAO[m], Log_DetermC_all(index_z2), B_lratio_min, B_lratio_max);
+						if(l<lnoBAO_min) lnoBAO_min=l;
+					}
+					Stat[STAT_LRATIO*SIMU_BATCH+sind]=lnoBAO_min-lBAO_min;
+				}
+
+				//each (point, simulation) has its own entry, or each point its rows of counts with -H
+				for(int s=0;s<NSTAT;s++)
+				{
+					const double *stat=Stat+s*SIMU_BATCH;
+					if(Histo==False)
+					{
+						float *histo=Stat_Histo[s].buffer()+sind0+(long) n_simu*row;
+						for(int sind=0; sind<nbatch; sind++) histo[sind]=stat[sind];
+					}
+					else
+					{
+						float *counts=Row+s*(nbin_histo+2);
+						for(int sind=0; sind<nbatch; sind++) counts[histo_bin(stat[sind], Histo_Min, Histo_Bin, nbin_histo)]+=1.;
+					}
+				}
+			}
+
+			//end of the point (see Checkpoint)
+			#pragma omp critical(checkpoint)
+			{
+				if(Histo==True)
+					for(int s=0;s<NSTAT;s++)
+					{
+						float *counts=Stat_Histo[s].buffer()+(long) row*(nbin_histo+2);
+						for(int i=0;i<nbin_histo+2;i++) counts[i]+=Row[s*(nbin_histo+2)+i];
+					}
+				N_Done[j]=(long) n_simu; Round[j]=1;
+				if(Ckpt.due()) Ckpt.write();
+			}
+		}
+		delete [] model0; delete [] g; delete [] y; delete [] Row;
+		delete [] X; delete [] X_Var; delete [] WX; delete [] WX2; delete [] Chi2_BAO; delete [] Chi2_noBAO; delete [] Work; delete [] Stat;
+	}
+	delete [] N_Done; delete [] K_Tail; delete [] Round;
+	delete [] Model_BAO; delete [] Model_noBAO; delete [] Index_Z; delete [] C_BAO; delete [] C_noBAO;
+
+    // Write the histograms
+	for(int s=0;s<NSTAT;s++)
+	{
+		if(NShard>1) write_shard(Name_Histo_Out[s], Stat_Histo[s], Shard, NShard, Histo==True, Histo_Min, Histo_Bin);
+		else if(Histo==False) fits_write_fltarr(Name_Histo_Out[s], Stat_Histo[s]);
+		else write_histo(Name_Histo_Out[s], Stat_Histo[s], Histo_Min, Histo_Bin);
+	}
+    Ckpt.remove();
+    exit(0);
+}
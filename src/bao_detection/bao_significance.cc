@@ -0,0 +1,491 @@
+/*******************************************************
+Program: 'bao_significance.cc'
+
+Significance of the BAO detection, for the Delta chi^2 statistic
+('delta_chi2') or the generalized likelihood ratio ('lratio'),
+with a constant or model-dependent covariance matrix. This is the
+C++ version of the idl procedure idl/sign_bao_detection.pro.
+
+For each point of the H0 (noBAO) grid, the histogram of the
+statistic gives a cumulative function F_i(x) at the bin centers;
+the conservative cumulative function used to reject all the H0
+models simultaneously is F(x)=min_i F_i(x) (see Labatie et al.
+2012). The p-value of a value x is 1-F(x) (linear interpolation
+between the bin centers, at least 1/n_simu), and its significance
+is the number of sigmas s with P(|g|>s)=p for g normal, given by
+the inverse normal function invgauss (src/cf_alpha/cf_tools.cc).
+The mean p-value and mean significance are averages over the H1
+(BAO) histogram, or, with the option -d, the p-value and
+significance of the data value are given.
+
+The inputs are either the statistic of every simulation written
+by 'delta_chi2'/'lratio' (n_simu values per point), binned here
+with the bin size of the option -b, or the streaming histograms
+written with their option -H (one row of counts per point, bin
+centers given by CRVAL1 and CDELT1).
+
+Version history:
+
+  V. 0.1 (19/10/2026): Initial version. Unlike the idl procedure,
+         the histograms of the points use exactly the bins of the
+         full H0 histogram (idl histogram with nbin=n0 between
+         min and max uses bins of width (max-min)/(n0-1)), and
+         the sigmas come from the inverse normal function instead
+         of a table of 10^7 normal draws.
+
+  V. 0.2 (19/10/2026): Inputs of the adaptive mode (-a) of
+         'delta_chi2'/'lratio', the p-value limit is 1/n for the
+         largest number n of simulations of a point.
+
+  V. 0.3 (19/10/2026): Option -i for the weighted H0 histograms of
+         the importance sampling (-S) of 'delta_chi2'/'lratio'.
+
+  V. 0.4 (19/10/2026): With -i the tail probabilities are the sums of
+         the weights divided by the number of simulations n_simu of a
+         point (unbiased), not by the sum of the weights.
+********************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include "Array.h"
+#include "IM_IO.h"
+#include "../cf_alpha/cf_tools.h"
+
+bool Verbose = false;
+bool Lratio = false;         //likelihood ratio instead of Delta chi^2
+bool VarCov = false;         //model-dependent covariance matrix
+bool Histo = false;          //inputs written with the option -H
+bool Data = false;           //significance of the data value
+bool Import = false;         //H0 histograms weighted by the importance sampling (option -S)
+double Bin_Size = 0.2;       //bin size of the histograms of the full outputs
+double N_Simu = -1;          //number of simulations per point of the full outputs
+
+char Name_H0[256];
+char Name_H1[256];
+char Name_Data[256];
+
+
+/***************************************************************************/
+
+static void usage(char *argv[])
+{
+
+  fprintf(stderr, "Usage: %s options [in_H0_file in_H1_file]\n\n", argv[0]);
+  fprintf(stderr, "   where options = \n");
+
+  fprintf(stderr, "         [-l]\n");
+  fprintf(stderr, "             Generalized likelihood ratio statistic ('lratio'),\n");
+  fprintf(stderr, "             default is Delta chi^2 ('delta_chi2').\n\n");
+
+  fprintf(stderr, "         [-c]\n");
+  fprintf(stderr, "             Model-dependent covariance matrix.\n\n");
+
+  fprintf(stderr, "         [-H]\n");
+  fprintf(stderr, "             Inputs are the histograms written with the option -H.\n\n");
+
+  fprintf(stderr, "         [-i]\n");
+  fprintf(stderr, "             H0 histograms of the importance sampling (option -S, implies -H):\n");
+  fprintf(stderr, "             the p-values are not limited by 1/n_simu.\n\n");
+
+  fprintf(stderr, "         [-b Bin_Size]\n");
+  fprintf(stderr, "             Bin size of the histograms of the full outputs, default is 0.2.\n\n");
+
+  fprintf(stderr, "         [-n N_Simu]\n");
+  fprintf(stderr, "             Number of simulations per point of the full outputs and of the\n");
+  fprintf(stderr, "             weighted histograms (-i), default is n_simu_bao_detection in the\n");
+  fprintf(stderr, "             param file.\n\n");
+
+  fprintf(stderr, "         [-d Name_Data]\n");
+  fprintf(stderr, "             Significance of the data value in Name_Data instead of\n");
+  fprintf(stderr, "             the mean significance under H1.\n\n");
+
+  fprintf(stderr, "         [-v]\n");
+  fprintf(stderr, "             Verbose.\n\n");
+
+  fprintf(stderr, "   The default input files are the outputs of 'delta_chi2'/'lratio'\n");
+  fprintf(stderr, "   in ../output_files/ for the chosen statistic.\n");
+
+  fprintf(stderr, "\n");
+  exit(-1);
+}
+
+
+void get_args(int argc, char *argv[])
+{
+  /* Start at i = 1 to skip the command name. */
+  int i=1;
+
+    /* Check for a switch (leading "-"). */
+
+  while(i<argc && argv[i][0] == '-') {
+
+      /* Use the next character to decide what to do. */
+
+    switch (argv[i][1]) {
+
+    case 'l': Lratio = true;
+      break;
+
+    case 'c': VarCov = true;
+      break;
+
+    case 'H': Histo = true;
+      break;
+
+    case 'i': Import = true; Histo = true;
+      break;
+
+    case 'b':
+      if(i+1==argc) usage(argv);
+      Bin_Size = atof(argv[++i]);
+      break;
+
+    case 'n':
+      if(i+1==argc) usage(argv);
+      N_Simu = atof(argv[++i]);
+      break;
+
+    case 'd':
+      if(i+1==argc) usage(argv);
+      strcpy(Name_Data, argv[++i]);
+      Data = true;
+      break;
+
+    case 'v': Verbose = true;
+      break;
+
+    case '?': usage(argv);
+      break;
+
+    default:  usage(argv);
+      break;
+    }
+    i++;
+  }
+
+  //default names as in idl/sign_bao_detection.pro
+  char Prefix[256];
+  if(Lratio) sprintf(Prefix, "../output_files/lratio/lratio_");
+  else sprintf(Prefix, "../output_files/delta_chi2/Dchi2_");
+  if(VarCov) strcat(Prefix, "varcov_");
+  sprintf(Name_H0, "%sh0%s.fits", Prefix, Histo ? "_histo" : "");
+  sprintf(Name_H1, "%sh1%s.fits", Prefix, Histo ? "_histo" : "");
+
+  if(i<argc-1){
+      strcpy(Name_H0, argv[i++]);
+      strcpy(Name_H1, argv[i++]);
+  }
+
+  if(i < argc){
+    fprintf(stderr, "Too many parameters: %s ...\n", argv[i]);
+    usage(argv);
+  }
+
+  if(Bin_Size<=0)
+  {
+    fprintf(stderr, "Error: the bin size must be positive\n");
+    exit(-1);
+  }
+}
+
+/*********************************************************************/
+
+//n_simu_bao_detection in the param file of 'delta_chi2' or 'lratio'
+double get_param_nsimu()
+{
+	char Name_Param_File[256];
+	sprintf(Name_Param_File, "../param/%s.param", Lratio ? "lratio" : "delta_chi2");
+	FILE *File=fopen(Name_Param_File,"r");
+
+    if (File == NULL)
+    {
+		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
+		exit(-1);
+    }
+	char Temp[256];
+	double n_simu=-1;
+	while(fscanf(File, "%255s", Temp)==1)
+		if(strcmp(Temp, "n_simu_bao_detection")==0)
+		{
+			if(fscanf(File, "%lf", &n_simu)!=1) n_simu=-1;
+			break;
+		}
+	fclose(File);
+	if(n_simu<=0)
+	{
+		cerr << "Error: no n_simu_bao_detection in " << Name_Param_File << endl;
+		exit(-1);
+	}
+	return n_simu;
+}
+
+/*********************************************************************/
+
+/* Histograms of the statistic on the common bins x(k)=X_Min+k*Dx (bin centers), k=0..NBin-1,
+   one row per point of the grid (Counts[i*NBin+k]) */
+class GridHisto {
+public:
+	int NGrid, NBin;
+	double X_Min, Dx;
+	double *Counts;
+
+	GridHisto() {NGrid=0; NBin=0; Counts=NULL;}
+	~GridHisto() {if(Counts!=NULL) delete [] Counts;}
+
+	//statistic of every simulation, n_simu values per point (n_simu<=0 for a single point)
+	void read_full(char *Name, double n_simu, double bin_size);
+	//streaming histograms of the option -H
+	void read_histo(char *Name);
+	//sum of the rows
+	void merge();
+	//number of simulations of the point i
+	double total(int i) const;
+};
+
+void GridHisto::read_full(char *Name, double n_simu, double bin_size)
+{
+	fltarray K;
+	fits_read_fltarr(Name, K);
+	long n=K.n_elem();
+	float *k=K.buffer();
+
+	//non finite values are set to the minimum, as in the idl procedure
+	float kmin=HUGE_VAL, kmax=-HUGE_VAL;
+	for(long l=0;l<n;l++)
+		if(isfinite(k[l]))
+		{
+			if(k[l]<kmin) kmin=k[l];
+			if(k[l]>kmax) kmax=k[l];
+		}
+	if(kmin>kmax)
+	{
+		cerr << "Error: no finite value in " << Name << endl;
+		exit(-1);
+	}
+	for(long l=0;l<n;l++) if(!isfinite(k[l])) k[l]=kmin;
+
+	long ns=(n_simu>0) ? (long) n_simu : n;
+	if(n%ns!=0)
+	{
+		cerr << "Error: " << n << " values in " << Name << " is not a multiple of n_simu=" << ns << endl;
+		exit(-1);
+	}
+	NGrid=n/ns;
+	Dx=bin_size;
+	NBin=(int) floor((kmax-kmin)/Dx)+1;
+	X_Min=kmin+0.5*Dx;
+	Counts=new double[(long) NGrid*NBin];
+	for(long l=0;l<(long) NGrid*NBin;l++) Counts[l]=0.;
+	for(long l=0;l<n;l++)
+	{
+		int b=(int) floor((k[l]-kmin)/Dx);
+		if(b>=NBin) b=NBin-1;
+		if(b<0) b=0;
+		Counts[(l/ns)*NBin+b]+=1.;
+	}
+}
+
+void GridHisto::read_histo(char *Name)
+{
+	fltarray K;
+	fitsstruct Header;
+	fits_read_fltarr(Name, K, &Header);
+	if(K.naxis()>2 || Header.cdeltx<=0)
+	{
+		cerr << "Error: " << Name << " is not a histogram file written with the option -H" << endl;
+		exit(-1);
+	}
+	NBin=K.nx();
+	NGrid=(K.naxis()==2) ? K.ny() : 1;
+	Dx=Header.cdeltx;
+	X_Min=Header.crvalx-(Header.crpixx-1.)*Dx;
+	Counts=new double[(long) NGrid*NBin];
+	for(long l=0;l<(long) NGrid*NBin;l++) Counts[l]=K.buffer()[l];
+}
+
+void GridHisto::merge()
+{
+	for(int i=1;i<NGrid;i++)
+		for(int b=0;b<NBin;b++) Counts[b]+=Counts[(long) i*NBin+b];
+	NGrid=1;
+}
+
+double GridHisto::total(int i) const
+{
+	double t=0.;
+	for(int b=0;b<NBin;b++) t+=Counts[(long) i*NBin+b];
+	return t;
+}
+
+/*********************************************************************/
+
+/* p-value of x with the conservative cumulative function F0 at the bin centers x0min+j*dx0,
+   as in the idl procedure */
+double pvalue(double x, const double *F0, int n0, double x0min, double dx0, double p_min)
+{
+	double p;
+	double t=(x-x0min)/dx0;
+	long ind=lround(t);
+	if(ind<0) p=1.0;
+	else if(ind>=n0) p=p_min;
+	else if(ind==0 || ind==n0-1) p=1.0-F0[ind];
+	else
+	{
+		double rest=t-ind;
+		if(rest<=0) p=1.0-fabs(rest)*F0[ind-1]-(1-fabs(rest))*F0[ind];
+		else p=1.0-fabs(rest)*F0[ind+1]-(1-fabs(rest))*F0[ind];
+	}
+	if(p<=p_min) p=p_min;
+	if(p>1.0) p=1.0;       //weighted tails (-i) can exceed 1 at the lowest bins
+	return p;
+}
+
+//number of sigmas s with P(|g|>s)=p
+double p2sigma(double p)
+{
+	int ifault;
+	if(p>=1.) return 0.;
+	return -invgauss(p/2., &ifault);
+}
+
+/*********************************************************************/
+
+int main(int argc, char ** argv)
+{
+	get_args(argc,argv);
+
+	//H0: histogram of each point of the grid
+	GridHisto H0;
+	if(Histo) H0.read_histo(Name_H0);
+	else
+	{
+		if(N_Simu<=0) N_Simu=get_param_nsimu();
+		H0.read_full(Name_H0, N_Simu, Bin_Size);
+	}
+	int n0=H0.NBin;
+
+	//number of simulations per point, the p-value limit uses the largest one (the points of
+	//the adaptive mode -a of 'delta_chi2'/'lratio' have different numbers of simulations).
+	//The rows of the importance sampling are sums of weights, their number of simulations is
+	//n_simu for every point (-S excludes -a)
+	double n_simu=0., n_simu_min=HUGE_VAL;
+	if(Import)
+	{
+		if(N_Simu<=0) N_Simu=get_param_nsimu();
+		n_simu=n_simu_min=N_Simu;
+	}
+	else
+		for(int i=0;i<H0.NGrid;i++)
+		{
+			if(H0.total(i)>n_simu) n_simu=H0.total(i);
+			if(H0.total(i)<n_simu_min) n_simu_min=H0.total(i);
+		}
+	for(int i=0;i<H0.NGrid;i++)
+		if(H0.total(i)<=0) n_simu_min=0;
+	if(n_simu_min<=0)
+	{
+		cerr << "Error: a point of the grid of " << Name_H0 << " has no simulation" << endl;
+		exit(-1);
+	}
+	double p_min=1.0/n_simu;
+
+	if(Verbose)
+	{
+		printf("\n\n# PARAMETERS: \n\n");
+		printf("# Statistic = %s, %s covariance matrix\n", Lratio ? "lratio" : "Delta chi2", VarCov ? "model-dependent" : "constant");
+		printf("# H0 = %s\n", Name_H0);
+		if(Data) printf("# Data = %s\n", Name_Data);
+		else printf("# H1 = %s\n", Name_H1);
+		printf("# Number of points of the grid = %d\n", H0.NGrid);
+		if(n_simu_min<n_simu) printf("# Number of simulations per point = %g .. %g\n", n_simu_min, n_simu);
+		else printf("# Number of simulations per point = %g\n", n_simu);
+		printf("# Bins: %d of size %g from %g\n\n", n0, H0.Dx, H0.X_Min);
+	}
+
+	//cumulative function of each point at the bin centers, and their minimum. With importance
+	//sampling it is one minus the tail, sum of the weights above the bin center divided by n_simu
+	//(unbiased, the weights do not sum exactly to n_simu)
+	double *F0=new double[n0];
+	double *f=new double[n0];
+	for(int j=0;j<n0;j++) F0[j]=HUGE_VAL;
+	for(int i=0;i<H0.NGrid;i++)
+	{
+		const double *h=H0.Counts+(long) i*n0;
+		if(Import)
+		{
+			double tail=h[n0-1]/n_simu/2.0;
+			f[n0-1]=1.0-tail;
+			for(int j=n0-2;j>=0;j--)
+			{
+				tail+=(h[j]+h[j+1])/n_simu/2.0;
+				f[j]=1.0-tail;
+			}
+		}
+		else
+		{
+			double t=H0.total(i);
+			f[0]=h[0]/t/2.0;
+			for(int j=1;j<n0;j++) f[j]=f[j-1]+(h[j]+h[j-1])/t/2.0;
+		}
+		for(int j=0;j<n0;j++) if(f[j]<F0[j]) F0[j]=f[j];
+	}
+	delete [] f;
+
+	//with importance sampling, the limit is the smallest tail probability resolved by the weighted histograms
+	if(Import)
+	{
+		for(int j=0;j<n0;j++) if(1.0-F0[j]>1e-12 && 1.0-F0[j]<p_min) p_min=1.0-F0[j];
+		if(Verbose) printf("# Smallest p-value of the weighted histograms = %g\n\n", p_min);
+	}
+
+	if(Data)
+	{
+		fltarray D;
+		fits_read_fltarr(Name_Data, D);
+		double x=D(0);
+		double p=pvalue(x, F0, n0, H0.X_Min, H0.Dx, p_min);
+		printf("data= %g\n", x);
+		printf("p= %g\n", p);
+		printf("sigma= %g\n", p2sigma(p));
+		if(p<=p_min && !Import) printf("(p-value at the limit 1/%g of the number of simulations)\n", n_simu);
+		if(p<=p_min && Import) printf("(p-value at the limit of the weighted histograms)\n");
+		delete [] F0;
+		exit(0);
+	}
+
+	//H1: histogram of all the points
+	GridHisto H1;
+	if(Histo) H1.read_histo(Name_H1);
+	else H1.read_full(Name_H1, -1, Bin_Size);
+	H1.merge();
+	int n1=H1.NBin;
+	double t1=H1.total(0);
+
+	//mean p-value and mean sigma under H1
+	double mean_p=0., mean_sigma=0.;
+	double sigma_lim=p2sigma(p_min), w_lim=0., mean_sigma_lim=0.;
+	for(int i=0;i<n1;i++)
+	{
+		double h1=H1.Counts[i]/t1;
+		if(h1==0.) continue;
+		double x=H1.X_Min+i*H1.Dx;
+		double p=pvalue(x, F0, n0, H0.X_Min, H0.Dx, p_min);
+		double sigma=p2sigma(p);
+		mean_p+=p*h1;
+		mean_sigma+=sigma*h1;
+		if(sigma<sigma_lim)
+		{
+			w_lim+=h1;
+			mean_sigma_lim+=sigma*h1;
+		}
+	}
+
+	printf("mean p= %g\n", mean_p);
+	printf("mean sigma= %g\n", mean_sigma);
+	printf("mean sigma for simu under threshold corresponding to %g simulations= %g\n", n_simu,
+	       (w_lim>0.) ? mean_sigma_lim/w_lim : 0.);
+
+	delete [] F0;
+	exit(0);
+}
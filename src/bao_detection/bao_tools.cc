@@ -0,0 +1,614 @@
+/*******************************************************
+File: 'bao_tools.cc'
+
+Linear algebra for the fits of the BAO detection programs
+'delta_chi2' and 'lratio', see bao_tools.h.
+********************************************************/
+
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include "Array.h"
+#include "IM_IO.h"
+#include "bao_tools.h"
+
+#ifdef BAO_CBLAS
+extern "C" {
+#include <cblas.h>
+}
+#endif
+
+#define GEMM_BLOCK_N 64     //rows of A in a block of the built-in gemm
+#define GEMM_BLOCK_M 32     //rows of B in a block of the built-in gemm
+
+
+bool cholesky(double *A, int n)
+{
+	for(int j=0;j<n;j++)
+	{
+		double s=A[j*n+j];
+		for(int k=0;k<j;k++) s-=A[j*n+k]*A[j*n+k];
+		if(s<=0.) return false;
+		double ljj=sqrt(s);
+		A[j*n+j]=ljj;
+		for(int i=j+1;i<n;i++)
+		{
+			s=A[i*n+j];
+			for(int k=0;k<j;k++) s-=A[i*n+k]*A[j*n+k];
+			A[i*n+j]=s/ljj;
+		}
+	}
+	return true;
+}
+
+/*********************************************************************/
+
+void chol_solve(const double *A, int n, double *x)
+{
+	//L y = b, then L^T x = y
+	for(int i=0;i<n;i++)
+	{
+		double s=x[i];
+		for(int k=0;k<i;k++) s-=A[i*n+k]*x[k];
+		x[i]=s/A[i*n+i];
+	}
+	for(int i=n-1;i>=0;i--)
+	{
+		double s=x[i];
+		for(int k=i+1;k<n;k++) s-=A[k*n+i]*x[k];
+		x[i]=s/A[i*n+i];
+	}
+}
+
+/*********************************************************************/
+
+void gemm_nt(int n, int m, int k, const double *A, const double *B, double *C)
+{
+#ifdef BAO_CBLAS
+	cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, n, m, k, 1., A, k, B, k, 0., C, m);
+#else
+	//blocks of B stay in cache while the rows of A are streamed
+	for(int j0=0;j0<m;j0+=GEMM_BLOCK_M)
+	{
+		int j1=(j0+GEMM_BLOCK_M<m) ? j0+GEMM_BLOCK_M : m;
+		for(int i0=0;i0<n;i0+=GEMM_BLOCK_N)
+		{
+			int i1=(i0+GEMM_BLOCK_N<n) ? i0+GEMM_BLOCK_N : n;
+			for(int i=i0;i<i1;i++)
+			{
+				const double *a=A+(long) i*k;
+				double *c=C+(long) i*m;
+				for(int j=j0;j<j1;j++)
+				{
+					const double *b=B+(long) j*k;
+					double s=0.;
+					for(int l=0;l<k;l++) s+=a[l]*b[l];
+					c[j]=s;
+				}
+			}
+		}
+	}
+#endif
+}
+
+/*********************************************************************/
+
+void ModelBank::free()
+{
+	if(Lt!=NULL) delete [] Lt;
+	if(Model!=NULL) delete [] Model;
+	if(Norm2!=NULL) delete [] Norm2;
+	Lt=NULL; Model=NULL; Norm2=NULL;
+	Nr=0; NModel=0;
+}
+
+void ModelBank::alloc(fltarray &iC, int nmodel)
+{
+	free();
+	Nr=iC.nx(); NModel=nmodel;
+	Lt=new double[Nr*Nr];
+	Model=new double[NModel*Nr];
+	Norm2=new double[NModel];
+
+	double *A=new double[Nr*Nr];
+	for(int i=0;i<Nr;i++)
+		for(int j=0;j<Nr;j++) A[i*Nr+j]=0.5*(iC(i,j)+iC(j,i));
+	if(!cholesky(A, Nr))
+	{
+		cerr << "Error: the inverse covariance matrix is not positive definite" << endl;
+		exit(-1);
+	}
+	for(int i=0;i<Nr;i++)
+		for(int j=0;j<Nr;j++) Lt[i*Nr+j]=(j>=i) ? A[j*Nr+i] : 0.;
+	delete [] A;
+}
+
+void ModelBank::set_model(int m, fltarray &model_all, int o, int a)
+{
+	double *x=new double[Nr];
+	for(int i=0;i<Nr;i++) x[i]=model_all(o,a,i);
+	Norm2[m]=whiten(x, Model+m*Nr);
+	delete [] x;
+}
+
+void ModelBank::set_model(int m, const double *model)
+{
+	Norm2[m]=whiten(model, Model+m*Nr);
+}
+
+double ModelBank::whiten(const double *x, double *wx) const
+{
+	double wx2=0.;
+	for(int i=0;i<Nr;i++)
+	{
+		const double *l=Lt+i*Nr;
+		double s=0.;
+		for(int j=i;j<Nr;j++) s+=l[j]*x[j];
+		wx[i]=s;
+		wx2+=s*s;
+	}
+	return wx2;
+}
+
+double ModelBank::min_chi2(const double *wx, double wx2, double B_min, double B_max, int *arg_min) const
+{
+	double chi2_min=HUGE_VAL;
+	for(int m=0;m<NModel;m++)
+	{
+		const double *wm=Model+m*Nr;
+		double p=0.;
+		for(int i=0;i<Nr;i++) p+=wx[i]*wm[i];
+		double B=p/Norm2[m];        //bias giving best-fit chi^2
+		if(B>B_max) B=B_max;
+		if(B<B_min) B=B_min;
+		double chi2=wx2-2.*B*p+B*B*Norm2[m];
+		if(chi2<chi2_min)
+		{
+			chi2_min=chi2;
+			if(arg_min!=NULL) *arg_min=m;
+		}
+	}
+	return chi2_min;
+}
+
+/*********************************************************************/
+
+void ModelBank::whiten_batch(int n, const double *X, double *WX, double *WX2) const
+{
+	gemm_nt(n, Nr, Nr, X, Lt, WX);
+	for(int i=0;i<n;i++)
+	{
+		const double *w=WX+(long) i*Nr;
+		double s=0.;
+		for(int j=0;j<Nr;j++) s+=w[j]*w[j];
+		WX2[i]=s;
+	}
+}
+
+void ModelBank::min_chi2_batch(int n, const double *WX, const double *WX2, double B_min, double B_max,
+                               double *Chi2_Min, double *Work, int *Arg_Min) const
+{
+	for(int i=0;i<n;i++) Chi2_Min[i]=HUGE_VAL;
+
+	for(int m0=0;m0<NModel;m0+=BANK_BLOCK)
+	{
+		int nm=(m0+BANK_BLOCK<NModel) ? BANK_BLOCK : NModel-m0;
+
+		//Work(i,m) = <w_i, m'_{m0+m}>
+		gemm_nt(n, nm, Nr, WX, Model+(long) m0*Nr, Work);
+
+		for(int i=0;i<n;i++)
+		{
+			const double *p=Work+(long) i*nm;
+			double chi2_min=Chi2_Min[i];
+			for(int m=0;m<nm;m++)
+			{
+				double norm2=Norm2[m0+m];
+				double B=p[m]/norm2;        //bias giving best-fit chi^2
+				if(B>B_max) B=B_max;
+				if(B<B_min) B=B_min;
+				double chi2=WX2[i]-2.*B*p[m]+B*B*norm2;
+				if(chi2<chi2_min)
+				{
+					chi2_min=chi2;
+					if(Arg_Min!=NULL) Arg_Min[i]=m0+m;
+				}
+			}
+			Chi2_Min[i]=chi2_min;
+		}
+	}
+}
+
+/*********************************************************************/
+
+int interp_nodes(double u, double v, int no, int na, int *O, int *A, double *W)
+{
+	int o0=(int) floor(u+INTERP_EPS), a0=(int) floor(v+INTERP_EPS);
+	double t=u-o0, w=v-a0;
+	if(o0<0 || a0<0 || o0>no-1 || a0>na-1 || (o0==no-1 && t>INTERP_EPS) || (a0==na-1 && w>INTERP_EPS))
+	{
+		cerr << "Error: interpolation out of the tables (" << u << " , " << v << ")" << endl;
+		exit(-1);
+	}
+	int n=0;
+	for(int i=0;i<2;i++)
+	{
+		double wo=(i==0) ? 1.-t : t;
+		if(wo<=INTERP_EPS) continue;
+		for(int k=0;k<2;k++)
+		{
+			double wa=(k==0) ? 1.-w : w;
+			if(wa<=INTERP_EPS) continue;
+			O[n]=o0+i; A[n]=a0+k; W[n]=wo*wa; n++;
+		}
+	}
+	return n;
+}
+
+void interp_model(fltarray &model_all, double u, double v, double *model)
+{
+	int O[4], A[4];
+	double W[4];
+	int n=interp_nodes(u, v, model_all.nx(), model_all.ny(), O, A, W);
+	int nr=model_all.nz();
+	if(n==1) for(int i=0;i<nr;i++) model[i]=model_all(O[0],A[0],i);
+	else
+		for(int i=0;i<nr;i++)
+		{
+			double s=0.;
+			for(int k=0;k<n;k++) s+=W[k]*model_all(O[k],A[k],i);
+			model[i]=s;
+		}
+}
+
+//log det C for an inverse covariance matrix iC (nr x nr), L is a work array of nr*nr
+static double log_det_cov(const float *iC, int nr, double *L)
+{
+	for(int l=0;l<nr*nr;l++) L[l]=iC[l];
+	if(!cholesky(L, nr))
+	{
+		cerr << "Error: inverse covariance matrix not positive definite" << endl;
+		exit(-1);
+	}
+	double ld=0.;
+	for(int i=0;i<nr;i++) ld-=2.0*log(L[i*nr+i]);
+	return ld;
+}
+
+void CovCache::free()
+{
+	for(std::map<std::pair<long,long>, std::pair<float *,double> >::iterator it=Cache.begin(); it!=Cache.end(); it++) delete [] it->second.first;
+	Cache.clear();
+	if(Offset!=NULL) delete [] Offset;
+	Mat=NULL; LogDet=NULL; Offset=NULL;
+}
+
+void CovCache::init(fltarray &mat_all, fltarray &log_det_all, int no, int na)
+{
+	free();
+	Mat=&mat_all; LogDet=&log_det_all; No=no; Na=na; Nr=mat_all.nx();
+	if(mat_all.ny()!=Nr || mat_all.nz()!=no*na || log_det_all.n_elem()!=no*na)
+	{
+		cerr << "Error: the table of matrices does not match the tables of parameters" << endl;
+		exit(-1);
+	}
+	Offset=new double[no*na];
+	double *L=new double[Nr*Nr];
+	for(int n=0;n<no*na;n++) Offset[n]=log_det_all(n)-log_det_cov(Mat->buffer()+(long) n*Nr*Nr, Nr, L);
+	delete [] L;
+}
+
+const float *CovCache::plane(double u, double v, double *log_det)
+{
+	int O[4], A[4];
+	double W[4];
+	int n=interp_nodes(u, v, No, Na, O, A, W);
+	if(n==1)
+	{
+		*log_det=(*LogDet)(Na*O[0]+A[0]);
+		return Mat->buffer()+(long) (Na*O[0]+A[0])*Nr*Nr;
+	}
+
+	//key of the point: its coordinates rounded to 1e-6 steps of the tables
+	std::pair<long,long> key((long) floor(u*1e6+0.5), (long) floor(v*1e6+0.5));
+	float *p=NULL;
+	double ld=0.;
+	#pragma omp critical(cov_cache)
+	{
+		std::map<std::pair<long,long>, std::pair<float *,double> >::iterator it=Cache.find(key);
+		if(it!=Cache.end()) {p=it->second.first; ld=it->second.second;}
+		else
+		{
+			p=new float[Nr*Nr];
+			for(int l=0;l<Nr*Nr;l++)
+			{
+				double s=0.;
+				for(int k=0;k<n;k++) s+=W[k]*Mat->buffer()[(long) (Na*O[k]+A[k])*Nr*Nr+l];
+				p[l]=s;
+			}
+			double *L=new double[Nr*Nr];
+			ld=log_det_cov(p, Nr, L);
+			delete [] L;
+			for(int k=0;k<n;k++) ld+=W[k]*Offset[Na*O[k]+A[k]];
+			Cache[key]=std::make_pair(p, ld);
+		}
+	}
+	*log_det=ld;
+	return p;
+}
+
+/*********************************************************************/
+
+void ContinuousFit::free()
+{
+	if(U!=NULL) delete [] U;
+	if(V!=NULL) delete [] V;
+	if(Model!=NULL) delete [] Model;
+	if(Gram!=NULL) delete [] Gram;
+	U=NULL; V=NULL; Model=NULL; Gram=NULL;
+	Nr=0; NO=0; NA=0; NU=0; NV=0;
+}
+
+void ContinuousFit::alloc(const ModelBank &bank, fltarray &model_all, const double *U_Grid, int no, const double *V_Grid, int na)
+{
+	free();
+	Nr=bank.nr(); NO=no; NA=na;
+	U=new double[NO];
+	V=new double[NA];
+	for(int k=0;k<NO;k++) U[k]=U_Grid[k];
+	for(int l=0;l<NA;l++) V[l]=V_Grid[l];
+	U0=(int) floor(U[0]+INTERP_EPS); NU=(int) ceil(U[NO-1]-INTERP_EPS)-U0+1;
+	V0=(int) floor(V[0]+INTERP_EPS); NV=(int) ceil(V[NA-1]-INTERP_EPS)-V0+1;
+
+	//one more row and column of zero models, for the nodes of weight 0 at the edges
+	long nnode=(long) (NU+1)*(NV+1);
+	Model=new double[nnode*Nr];
+	Gram=new double[5*nnode];
+	for(long l=0;l<nnode*Nr;l++) Model[l]=0.;
+	for(long l=0;l<5*nnode;l++) Gram[l]=0.;
+	double *x=new double[Nr];
+	for(int i=0;i<NU;i++)
+		for(int j=0;j<NV;j++)
+		{
+			for(int r=0;r<Nr;r++) x[r]=model_all(U0+i,V0+j,r);
+			bank.whiten(x, Model+(long) (i*(NV+1)+j)*Nr);
+		}
+	delete [] x;
+	for(int i=0;i<NU;i++)
+		for(int j=0;j<NV;j++)
+		{
+			long n=i*(NV+1)+j;
+			const double *m=Model+n*Nr;
+			Gram[5*n]=dot(Nr, m, m);
+			Gram[5*n+1]=dot(Nr, m, m+Nr);
+			Gram[5*n+2]=dot(Nr, m, m+(NV+1)*Nr);
+			Gram[5*n+3]=dot(Nr, m, m+(NV+2)*Nr);
+			Gram[5*n+4]=dot(Nr, m+(NV+1)*Nr, m+Nr);
+		}
+}
+
+double ContinuousFit::chi2(const double *wx, double wx2, double u, double v, double B_min, double B_max) const
+{
+	int i=(int) floor(u+INTERP_EPS)-U0, j=(int) floor(v+INTERP_EPS)-V0;
+	if(i>NU-2) i=NU-2;
+	if(i<0) i=0;
+	if(j>NV-2) j=NV-2;
+	if(j<0) j=0;
+	double t=u-U0-i, w=v-V0-j;
+
+	//nodes n, n+v, n+u, n+u+v of the cell and their weights
+	long n=i*(NV+1)+j;
+	long Node[4]={n, n+1, n+NV+1, n+NV+2};
+	double W[4]={(1.-t)*(1.-w), (1.-t)*w, t*(1.-w), t*w};
+	double p=0.;
+	for(int c=0;c<4;c++)
+		if(W[c]>INTERP_EPS) p+=W[c]*dot(Nr, wx, Model+Node[c]*Nr);
+	const double *G=Gram+5*n;
+	double norm2=W[0]*W[0]*G[0]+W[1]*W[1]*Gram[5*Node[1]]+W[2]*W[2]*Gram[5*Node[2]]+W[3]*W[3]*Gram[5*Node[3]]
+	            +2.*(W[0]*W[1]*G[1]+W[0]*W[2]*G[2]+W[0]*W[3]*G[3]+W[1]*W[2]*G[4]
+	                 +W[1]*W[3]*Gram[5*Node[1]+2]+W[2]*W[3]*Gram[5*Node[2]+1]);
+
+	double B=p/norm2;        //bias giving best-fit chi^2
+	if(B>B_max) B=B_max;
+	if(B<B_min) B=B_min;
+	return wx2-2.*B*p+B*B*norm2;
+}
+
+double ContinuousFit::brent(const double *wx, double wx2, int dir, double fixed, double a, double x, double fx, double b,
+                            double tol, double B_min, double B_max, long *n_eval, double *x_min) const
+{
+	const double cgold=0.3819660;      //(3-sqrt(5))/2
+
+	//x has the smallest chi^2 found, w the second smallest and v the previous w, the new point u
+	//is the minimum of the parabola through x, w, v when it falls in [a,b] and the steps decrease,
+	//a golden section of the largest of [a,x] and [x,b] otherwise
+	double w=x, v=x, fw=fx, fv=fx;
+	double d=0., e=0.;
+	for(int it=0; it<FIT_ITMAX; it++)
+	{
+		double xm=0.5*(a+b);
+		if(fabs(x-xm)<=2.*tol-0.5*(b-a)) break;
+		bool golden=true;
+		if(fabs(e)>tol)
+		{
+			double r=(x-w)*(fx-fv), q=(x-v)*(fx-fw), p=(x-v)*q-(x-w)*r;
+			q=2.*(q-r);
+			if(q>0.) p=-p;
+			q=fabs(q);
+			double e_prev=e;
+			e=d;
+			if(fabs(p)<fabs(0.5*q*e_prev) && p>q*(a-x) && p<q*(b-x))
+			{
+				d=p/q;
+				if(x+d-a<2.*tol || b-x-d<2.*tol) d=(xm>=x) ? tol : -tol;
+				golden=false;
+			}
+		}
+		if(golden)
+		{
+			e=(x>=xm) ? a-x : b-x;
+			d=cgold*e;
+		}
+		double u=(fabs(d)>=tol) ? x+d : x+((d>=0.) ? tol : -tol);
+		double fu=(dir==0) ? chi2(wx, wx2, fixed, u, B_min, B_max) : chi2(wx, wx2, u, fixed, B_min, B_max);
+		(*n_eval)++;
+		if(fu<=fx)
+		{
+			if(u>=x) a=x; else b=x;
+			v=w; fv=fw; w=x; fw=fx; x=u; fx=fu;
+		}
+		else
+		{
+			if(u<x) a=u; else b=u;
+			if(fu<=fw || w==x) {v=w; fv=fw; w=u; fw=fu;}
+			else if(fu<=fv || v==x || v==w) {v=u; fv=fu;}
+		}
+	}
+	*x_min=x;
+	return fx;
+}
+
+double ContinuousFit::refine(const double *wx, double wx2, int m, double chi2_m, double B_min, double B_max,
+                             double tol, long *n_eval) const
+{
+	double u=U[m/NA], v=V[m%NA], f=chi2_m;
+	double du=(NO>1) ? U[1]-U[0] : 0., dv=(NA>1) ? V[1]-V[0] : 0.;
+	for(int sweep=0; sweep<FIT_SWEEP; sweep++)
+	{
+		double f0=f;
+		if(NA>1) f=brent(wx, wx2, 0, u, (v-dv>V[0]) ? v-dv : V[0], v, f, (v+dv<V[NA-1]) ? v+dv : V[NA-1], tol*dv, B_min, B_max, n_eval, &v);
+		if(NO>1) f=brent(wx, wx2, 1, v, (u-du>U[0]) ? u-du : U[0], u, f, (u+du<U[NO-1]) ? u+du : U[NO-1], tol*du, B_min, B_max, n_eval, &u);
+		if(f0-f<=FIT_FTOL) break;
+	}
+	return f;
+}
+
+/*********************************************************************/
+
+void write_histo(char *Name, fltarray &Counts, double histo_min, double histo_bin)
+{
+	fitsstruct Header;
+	initfield(&Header);
+	Header.bitpix = -32;
+	Header.width = Counts.nx();
+	Header.height = Counts.ny();
+	Header.naxis = Counts.naxis();
+	Header.npix = Counts.n_elem();
+	for(int i=0; i<Header.naxis; i++) Header.TabAxis[i] = Counts.axis(i+1);
+	Header.crpixx = 1.;
+	Header.crvalx = histo_min-histo_bin/2.;
+	Header.cdeltx = histo_bin;
+	fits_write_fltarr(Name, Counts, &Header);
+}
+
+void write_shard(char *Name, fltarray &Out, int shard, int nshard, bool histo, double histo_min, double histo_bin)
+{
+	fitsstruct Header;
+	initfield(&Header);
+	Header.bitpix = -32;
+	Header.width = Out.nx();
+	Header.height = Out.ny();
+	Header.naxis = Out.naxis();
+	Header.npix = Out.n_elem();
+	for(int i=0; i<Header.naxis; i++) Header.TabAxis[i] = Out.axis(i+1);
+	if(histo)
+	{
+		Header.crpixx = 1.;
+		Header.crvalx = histo_min-histo_bin/2.;
+		Header.cdeltx = histo_bin;
+	}
+	Header.crpixy = 1.;
+	Header.crvaly = shard;
+	Header.cdelty = nshard;
+	fits_write_fltarr(Name, Out, &Header);
+}
+
+/*********************************************************************/
+
+#define CKPT_MAGIC "BAOlab_ckpt_1"
+
+void Checkpoint::init(const char *Name_Out, const double *key, int nkey, fltarray *out, int nout, int ngrid,
+                      long *n_done, long *k_tail, int *round, double *p_ref, long *seed)
+{
+	sprintf(Name, "%s.ckpt", Name_Out);
+	delete [] Key;
+	NKey=nkey; Key=new double[NKey];
+	for(int k=0;k<NKey;k++) Key[k]=key[k];
+	Out=out; NOut=nout; NGrid=ngrid;
+	N_Done=n_done; K_Tail=k_tail; Round=round;
+	P_Ref=p_ref; Seed=seed;
+	Last=time(NULL);
+}
+
+void Checkpoint::write()
+{
+	char Name_Tmp[264];
+	sprintf(Name_Tmp, "%s.tmp", Name);
+	FILE *File=fopen(Name_Tmp, "wb");
+	if(File==NULL)
+	{
+		cerr << "Error: cannot write the checkpoint " << Name_Tmp << endl;
+		exit(-1);
+	}
+	bool ok=fwrite(CKPT_MAGIC, 1, sizeof(CKPT_MAGIC), File)==sizeof(CKPT_MAGIC)
+	     && fwrite(&NKey, sizeof(int), 1, File)==1
+	     && fwrite(Key, sizeof(double), NKey, File)==(size_t) NKey
+	     && fwrite(Seed, sizeof(long), 1, File)==1
+	     && fwrite(P_Ref, sizeof(double), 1, File)==1
+	     && fwrite(N_Done, sizeof(long), NGrid, File)==(size_t) NGrid
+	     && fwrite(K_Tail, sizeof(long), NGrid, File)==(size_t) NGrid
+	     && fwrite(Round, sizeof(int), NGrid, File)==(size_t) NGrid;
+	for(int o=0;ok && o<NOut;o++)
+		ok=fwrite(Out[o].buffer(), sizeof(float), Out[o].n_elem(), File)==(size_t) Out[o].n_elem();
+	ok=ok && fflush(File)==0 && fsync(fileno(File))==0;
+	if(fclose(File)!=0 || !ok || rename(Name_Tmp, Name)!=0)
+	{
+		cerr << "Error: cannot write the checkpoint " << Name << endl;
+		exit(-1);
+	}
+	Last=time(NULL);
+}
+
+bool Checkpoint::read()
+{
+	FILE *File=fopen(Name, "rb");
+	if(File==NULL) return false;
+
+	char magic[sizeof(CKPT_MAGIC)];
+	int nkey=-1;
+	bool ok=fread(magic, 1, sizeof(CKPT_MAGIC), File)==sizeof(CKPT_MAGIC)
+	     && memcmp(magic, CKPT_MAGIC, sizeof(CKPT_MAGIC))==0
+	     && fread(&nkey, sizeof(int), 1, File)==1 && nkey==NKey;
+	for(int k=0;ok && k<NKey;k++)
+	{
+		double key;
+		ok=fread(&key, sizeof(double), 1, File)==1 && key==Key[k];
+	}
+	if(!ok)
+	{
+		cerr << "Error: the checkpoint " << Name << " is not from a run with the same parameters" << endl;
+		exit(-1);
+	}
+
+	ok=fread(Seed, sizeof(long), 1, File)==1
+	     && fread(P_Ref, sizeof(double), 1, File)==1
+	     && fread(N_Done, sizeof(long), NGrid, File)==(size_t) NGrid
+	     && fread(K_Tail, sizeof(long), NGrid, File)==(size_t) NGrid
+	     && fread(Round, sizeof(int), NGrid, File)==(size_t) NGrid;
+	for(int o=0;ok && o<NOut;o++)
+		ok=fread(Out[o].buffer(), sizeof(float), Out[o].n_elem(), File)==(size_t) Out[o].n_elem();
+	fclose(File);
+	if(!ok)
+	{
+		cerr << "Error: cannot read the checkpoint " << Name << endl;
+		exit(-1);
+	}
+	return true;
+}
+
+void Checkpoint::remove() const
+{
+	::remove(Name);
+}
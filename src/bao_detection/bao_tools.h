@@ -0,0 +1,369 @@
+/***********************************************************
+**
+**    File:  	bao_tools.h
+**
+************************************************************
+**
+**  Linear algebra for the fits of the BAO detection programs
+**  'delta_chi2' and 'lratio'
+**
+**  With a constant inverse covariance matrix iC = L L^T
+**  (Cholesky), the scalar products <x,iC y> are the euclidian
+**  scalar products of the whitened vectors L^T x and L^T y.
+**  The models of the fitting grid are whitened once, so the
+**  best-fit chi^2 of a simulation xi for a model m is
+**     chi2(B) = |w|^2 - 2 B <w,m'> + B^2 |m'|^2
+**  with w=L^T xi, m'=L^T m, and only costs a scalar product.
+**
+**  For a batch of simulations, the scalar products with all the
+**  models are the matrix product W M'^T (batch x models), done
+**  by blocks of models with gemm_nt (cblas_dgemm when compiled
+**  with -DBAO_CBLAS, a built-in blocked kernel otherwise), the
+**  minimum chi^2 being reduced block by block.
+**
+**  With the option -H the statistic is not stored for every
+**  simulation but accumulated in a fixed-bin histogram for each
+**  point of the hypothesis grid (see histo_bin, write_histo).
+**
+************************************************************/
+
+
+#ifndef	_BAO_TOOLS_H_
+#define	_BAO_TOOLS_H_
+
+#include <ctime>
+#include <map>
+#include <utility>
+#include "Array.h"
+
+#define BANK_BLOCK 256      //number of models in a block of the batched fits
+#define SIMU_BATCH 256      //number of simulations fitted at once
+
+//C = A B^T with A (n x k), B (m x k) and C (n x m), all row-major and contiguous
+void gemm_nt(int n, int m, int k, const double *A, const double *B, double *C);
+
+//Progress of the loop over the grid points, called once per point by any thread: the
+//count is an atomic increment and in verbose mode at most one line per percent is printed
+inline void progress(long *count, long total, bool verbose)
+{
+	long done;
+	#pragma omp atomic capture
+	done=++(*count);
+	if(verbose && (done*100/total!=(done-1)*100/total || done==total))
+		printf("%ld/%ld\n", done, total);
+}
+
+
+/* Kernels on vectors of size n and on n x n matrices stored as a plane of a
+   fltarray (element (i,k) in A[k*n+i], A=Mat.buffer()+index_z*n*n), used in
+   the simulation loops with preallocated buffers instead of fltarray temporaries */
+
+//<x,y>
+inline double dot(int n, const double *x, const double *y)
+{
+	double s=0.;
+	for(int i=0;i<n;i++) s+=x[i]*y[i];
+	return s;
+}
+
+//y += a x
+inline void axpy(int n, double a, const double *x, double *y)
+{
+	for(int i=0;i<n;i++) y[i]+=a*x[i];
+}
+
+//x = a x
+inline void scal(int n, double a, double *x)
+{
+	for(int i=0;i<n;i++) x[i]*=a;
+}
+
+//y = A x
+inline void matvec(int n, const float *A, const double *x, double *y)
+{
+	for(int i=0;i<n;i++) y[i]=0.;
+	for(int k=0;k<n;k++)
+	{
+		const float *a=A+k*n;
+		double xk=x[k];
+		for(int i=0;i<n;i++) y[i]+=a[i]*xk;
+	}
+}
+
+//<x,A y>
+inline double bilinear(int n, const float *A, const double *x, const double *y)
+{
+	double s=0.;
+	for(int k=0;k<n;k++)
+	{
+		const float *a=A+k*n;
+		double t=0.;
+		for(int i=0;i<n;i++) t+=a[i]*x[i];
+		s+=t*y[k];
+	}
+	return s;
+}
+
+//<x,A x>
+inline double quadratic(int n, const float *A, const double *x)
+{
+	return bilinear(n, A, x, x);
+}
+
+/* Best fit for the varying covariance matrix iC (plane of iC_all) and log_det its log determinant:
+   minimize 2*nr*log(B)+log_det+1/B^2*<xi-B*xi_m,iC#(xi-B*xi_m)>, with a=<xi,iC#xi>, b=<xi,iC#xi_m>
+   and c=<xi_m,iC#xi_m>. 1/B is the root of the equation a*X^2-b*X-nr, B=2*a/(b+sqrt(b^2+4*nr*a)) */
+inline double fit_varcov(int nr, double a, double b, double c, double log_det, double B_fit_min, double B_fit_max)
+{
+	double B2=2*a/(b+sqrt(b*b+4*nr*a)); //bias giving best-fit 
+	if(B2>B_fit_max) B2=B_fit_max;
+	if(B2<B_fit_min) B2=B_fit_min;
+	return 2.0*nr*log(B2)+log_det+1.0/(B2*B2)*a-1.0/B2*2.0*b+c;
+}
+
+//Cholesky factorization A = L L^T of the symmetric positive definite n x n matrix A,
+//L is written in the lower triangle of A (A[i*n+j], i>=j), return false if A is not
+//positive definite
+bool cholesky(double *A, int n);
+
+
+/* Whitened models of the fitting grid for a constant inverse covariance matrix */
+class ModelBank {
+	int Nr;
+	int NModel;
+	double *Lt;         //whitening matrix L^T (Lt[i*Nr+j], j>=i)
+	double *Model;      //whitened model m: Model[m*Nr+i]
+	double *Norm2;      //|L^T m|^2
+
+public:
+	ModelBank() {Nr=0; NModel=0; Lt=NULL; Model=NULL; Norm2=NULL;}
+	~ModelBank() {free();}
+	void free();
+
+	//whitening matrix of the inverse covariance matrix iC (nr x nr), and room for nmodel models
+	void alloc(fltarray &iC, int nmodel);
+
+	//whitened model m from model_all(o,a,*) (model_all of dimensions (no,na,nr))
+	void set_model(int m, fltarray &model_all, int o, int a);
+	//whitened model m from the vector model (nr)
+	void set_model(int m, const double *model);
+
+	inline int nr() const {return Nr;}
+	inline int nmodel() const {return NModel;}
+
+	//whitened vector wx=L^T x, return |wx|^2
+	double whiten(const double *x, double *wx) const;
+
+	//minimum over the models of the chi^2 of the whitened vector wx (|wx|^2=wx2), the bias B
+	//of each model being the best fit in [B_min,B_max]
+	double min_chi2(const double *wx, double wx2, double B_min, double B_max, int *arg_min=NULL) const;
+
+	//same for the n rows of X (n x nr): whitened vectors WX (n x nr) and WX2,
+	//minimum chi^2 in Chi2_Min, Work must have n*BANK_BLOCK elements
+	void whiten_batch(int n, const double *X, double *WX, double *WX2) const;
+	//(with Arg_Min, the model of each minimum is written in Arg_Min)
+	void min_chi2_batch(int n, const double *WX, const double *WX2, double B_min, double B_max,
+	                    double *Chi2_Min, double *Work, int *Arg_Min=NULL) const;
+};
+
+
+/* Bilinear interpolation between the nodes of the tables of (Omega_m h^2, alpha), for the fitting
+   grids finer than the tables (option -f): a point is given by its coordinates (u,v) in steps of
+   the tables, o=o_table(0)+u*delta_o_table and alpha=a_table(0)+v*delta_a_table. At a node
+   (integer u and v) the values are exactly the tabulated ones. Between the nodes the models and
+   the inverse covariance matrices are interpolated linearly in o and in alpha, as the
+   model-dependent covariance matrix between the Omega_m h^2 of the lognormal simulations (see
+   idl/script.pro) */
+
+#define INTERP_EPS 1e-9     //distance to a node below which a coordinate is the node
+
+//nodes (O[k],A[k]) and weights W[k] of the point (u,v) of tables of size no x na, return
+//their number (1 at a node, 2 on a line of the tables, 4 otherwise)
+int interp_nodes(double u, double v, int no, int na, int *O, int *A, double *W);
+
+//model at (u,v) from model_all (dimensions (no,na,nr))
+void interp_model(fltarray &model_all, double u, double v, double *model);
+
+/* Inverse covariance matrices at (u,v) from a table of matrices (node (o,a) in the plane na*o+a,
+   i.e. iC_all): the plane of the table at a node, otherwise the interpolated plane, computed the first
+   time it is asked and then kept in the cache. The log-determinant of the covariance matrix is the
+   one of the table at a node, otherwise the one of the interpolated plane itself (-2 sum log L_ii
+   with L the Cholesky factor of the plane), so that both describe the same Gaussian. The table is
+   log det(C/m) (see transform_covmatrix), its constant offset to log det C is measured at the
+   nodes and added between the nodes. plane() can be called by several threads, the pointers stay
+   valid until free() */
+class CovCache {
+	fltarray *Mat, *LogDet;
+	int No, Na, Nr;
+	double *Offset;     //log-determinant of the table minus the one of the plane, at each node
+	std::map<std::pair<long,long>, std::pair<float *,double> > Cache;
+
+public:
+	CovCache() {Mat=NULL; LogDet=NULL; Offset=NULL; No=0; Na=0; Nr=0;}
+	~CovCache() {free();}
+	void free();
+
+	//table mat_all (nr,nr,no*na) and log-determinants log_det_all (no*na)
+	void init(fltarray &mat_all, fltarray &log_det_all, int no, int na);
+	const float *plane(double u, double v, double *log_det);
+
+	//number of interpolated planes in the cache
+	int size() const {return (int) Cache.size();}
+};
+
+
+/* Continuous fit (option -m of 'delta_chi2'): the best model of the fitting grid (U[k],V[l])
+   is refined by Brent's method in alpha and in Omega_m h^2 in turn, within one step of the grid
+   around the current point, with the models interpolated between the nodes of the tables as
+   above. The whitened models m'_n of the nodes and their scalar products with the neighbouring
+   nodes are kept, so that in a cell of the tables with the weights W_n of its four nodes
+      <w,m'(u,v)> = sum_n W_n <w,m'_n>      |m'(u,v)|^2 = sum_n sum_n' W_n W_n' <m'_n,m'_n'>
+   and each chi^2 costs at most four scalar products */
+
+#define FIT_ITMAX 100       //maximum number of iterations of a minimisation in one direction
+#define FIT_SWEEP 10        //maximum number of minimisations in alpha then Omega_m h^2
+#define FIT_FTOL 1e-6       //decrease of chi^2 below which the sweeps stop
+
+class ContinuousFit {
+	int Nr;
+	int NO, NA;         //fitting grid (U[k],V[l])
+	double *U, *V;
+	int U0, NU, V0, NV; //nodes (U0..U0+NU-1,V0..V0+NV-1) of the tables covering the grid
+	double *Model;      //whitened model of the node (U0+i,V0+j): Model[(i*(NV+1)+j)*Nr], zero for i=NU or j=NV
+	double *Gram;       //scalar products of the node n with n, n+v, n+u, n+u+v, and of n+u with n+v: Gram[5*n+0..4]
+
+	//chi^2 along alpha (dir=0, u fixed) or Omega_m h^2 (dir=1, v fixed): minimum in [a,b] from x
+	//(f(x)=fx) within tol, the point of the minimum is written in *x_min
+	double brent(const double *wx, double wx2, int dir, double fixed, double a, double x, double fx, double b,
+	             double tol, double B_min, double B_max, long *n_eval, double *x_min) const;
+
+public:
+	ContinuousFit() {Nr=0; NO=0; NA=0; NU=0; NV=0; U=NULL; V=NULL; Model=NULL; Gram=NULL;}
+	~ContinuousFit() {free();}
+	void free();
+
+	//models of model_all (dimensions (no,na,nr)) whitened by bank, fitting grid of no x na
+	//points (U[k],V[l]) in steps of the tables (model m=k*na+l of bank)
+	void alloc(const ModelBank &bank, fltarray &model_all, const double *U_Grid, int no, const double *V_Grid, int na);
+
+	//chi^2 of the whitened vector wx at (u,v), the bias being the best fit in [B_min,B_max]
+	double chi2(const double *wx, double wx2, double u, double v, double B_min, double B_max) const;
+
+	//minimum of the chi^2 near the model m of the grid (chi2_m its chi^2), within tol steps of
+	//the grid in each direction, the number of chi^2 computed is added to *n_eval
+	double refine(const double *wx, double wx2, int m, double chi2_m, double B_min, double B_max,
+	              double tol, long *n_eval) const;
+};
+
+
+/* Adaptive mode (option -a): after n simulations of a point of the H0 grid with k of them
+   above the observed statistic, its tail probability is estimated by (k+1)/(n+2), and the
+   point is finished when the standard error of this estimate is below rel_err*p_ref, p_ref
+   being the largest tail probability of the grid after a first round of ADAPT_PILOT
+   simulations for every point (the p-value is decided by the maximum over the grid) */
+
+#define ADAPT_PILOT 1024    //simulations of the first round of the adaptive mode
+
+inline bool adapt_converged(long k, long n, double p_ref, double rel_err)
+{
+	double p=(k+1.)/(n+2.);
+	return sqrt(p*(1.-p)/n)<=rel_err*p_ref;
+}
+
+
+/* Importance sampling (option -S): under H0 half of the Gaussian vectors g of the simulations
+   are drawn from N(0,I) and the other half from N(mu_k,I), k=1..K in turn, mu_k moving the mean
+   of xi toward the BAO feature of the k-th alpha of the fitting grid (a large Delta chi2 under
+   H0 can mimic the BAO at any alpha). Each simulation has the weight of the mixture proposal
+      w = phi(g)/(phi(g)/2+sum_k phi(g-mu_k)/2K) = 1/(1/2+sum_k exp(<mu_k,g>-|mu_k|^2/2)/2K)
+   which is at most 2. The weighted histogram of a point divided by its number of simulations
+   (not by the sum of the weights) is an unbiased estimate of the H0 histogram, with many more
+   simulations in the tail */
+
+//solve A x = b with the Cholesky factor of 'cholesky' in A, x contains b on input
+void chol_solve(const double *A, int n, double *x);
+
+//weight of g for the K shifts MU (K*n) of squared norms MU2
+inline double is_weight(int n, int K, const double *MU, const double *MU2, const double *g)
+{
+	double s=0.;
+	for(int k=0;k<K;k++) s+=exp(dot(n, MU+(long) k*n, g)-0.5*MU2[k]);
+	return 1.0/(0.5+0.5*s/K);
+}
+
+
+/* Streaming histograms (option -H): one row of Nbin+2 counts per point of the hypothesis
+   grid, bin i=1..Nbin covers [Histo_Min+(i-1)*Histo_Bin, Histo_Min+i*Histo_Bin[, bin 0 counts
+   the values below Histo_Min (and non finite values) and bin Nbin+1 those above Histo_Max */
+
+inline int histo_nbin(double histo_min, double histo_max, double histo_bin)
+{
+	return (int) ceil((histo_max-histo_min)/histo_bin-1e-6);
+}
+
+inline int histo_bin(double x, double histo_min, double histo_bin, int nbin)
+{
+	if(!(x>=histo_min)) return 0;
+	double t=(x-histo_min)/histo_bin;
+	if(t>=nbin) return nbin+1;
+	return (int) t+1;
+}
+
+//Write the counts (Nbin+2, Ngrid) with the bins in the FITS keywords of axis 1: the center
+//of bin i (i=0..Nbin+1) is CRVAL1+i*CDELT1 with CRVAL1=Histo_Min-Histo_Bin/2
+void write_histo(char *Name, fltarray &Counts, double histo_min, double histo_bin);
+
+/* Shards (option --shard k/K): a run only does the points j=k+r*K of the hypothesis grid and
+   writes their rows r (the n_simu statistics, or the counts of -H) in a partial output, the
+   keywords of axis 2 giving the point of each row, j=CRVAL2+r*CDELT2 (CRVAL2=k, CDELT2=K).
+   'merge_shards' puts the K partial outputs together in the output of a run without shards */
+
+void write_shard(char *Name, fltarray &Out, int shard, int nshard, bool histo, double histo_min, double histo_bin);
+
+
+/* Checkpoints of the loop over the hypothesis grid: the state of the loop (output arrays, and for
+   each point the simulations done, the tail count of -a and the number of rounds finished) is
+   written when a point is finished, at most every CKPT_PERIOD seconds, in the file
+   <output>.ckpt. It is written under a temporary name and renamed, so the file on disk is always
+   complete. With the option -R the run starts from this file: the finished points are skipped and
+   the other ones start again from their last finished round, so that the output is the same as
+   without interruption. */
+
+#ifndef CKPT_PERIOD
+#define CKPT_PERIOD 600     //seconds between two checkpoints
+#endif
+
+class Checkpoint {
+	char Name[256];
+	int NKey;
+	double *Key;        //parameters of the run, which must be the same to resume it
+	time_t Last;        //time of the last write
+	fltarray *Out;      //NOut output arrays
+	int NOut;
+	int NGrid;
+	long *N_Done, *K_Tail;
+	int *Round;
+	double *P_Ref;
+	long *Seed;
+
+public:
+	Checkpoint() {NKey=0; Key=NULL;}
+	~Checkpoint() {delete [] Key;}
+
+	//checkpoint of the nout outputs out (named after Name_Out), with the state of the loop over ngrid points
+	void init(const char *Name_Out, const double *key, int nkey, fltarray *out, int nout, int ngrid,
+	          long *n_done, long *k_tail, int *round, double *p_ref, long *seed);
+
+	//true when the last write is older than CKPT_PERIOD
+	bool due() const {return difftime(time(NULL), Last)>=CKPT_PERIOD;}
+	void write();
+
+	//restore the state, false if there is no checkpoint (the state is not changed)
+	bool read();
+
+	//delete the file at the end of the run
+	void remove() const;
+	const char *name() const {return Name;}
+};
+
+#endif
@@ -22,8 +22,12 @@
 
 #include "Array.h"
 #include "IM_IO.h"
+#include "bao_tools.h"
+#include "RandStream.h"
 #include <omp.h>
 
+#define CHECK_TOL 1e-3      //difference of chi^2 counted by -V
+
 
 int h=0;
 Bool Verbose=False;
@@ -48,6 +52,23 @@ double n_simu;
 char Name_Histo_Out_Prefix[256];		/* output file prefix name */
 
 
+Bool Histo=False;    //streaming histograms instead of the statistic of every simulation (-H)
+double Histo_Min,Histo_Max,Histo_Bin;    //range and bin size of the streaming histograms
+Bool Histo_Param=False;
+Bool Adapt=False;    //adaptive number of simulations per point (-a)
+double Rel_Err;      //target error of the tail probabilities in the adaptive mode
+double Stat_Obs;     //observed statistic for the adaptive mode
+Bool Stat_Obs_Set=False;
+Bool Import=False;   //importance sampling of the H0 simulations (-S)
+double IS_Shift;     //shift of the proposal toward the BAO model
+Bool Resume=False;   //start from the checkpoint of an interrupted run (-R)
+int Shard=0, NShard=1;   //points j of the grid with j%NShard==Shard (--shard)
+int Fit_Sub=1;       //points of the fitting grid per step of the hypothesis grid (-f)
+Bool Minimise=False; //best fits of the grid refined by Brent's method (-m)
+double Fit_Tol;      //tolerance of the minimisation in steps of the fitting grid
+int Check_Sub=0;     //points per step of the grid of the full scan checking the minimisation (-V)
+long seed;    //seed of the random streams
+
 //maximum number of procs used for the loops
 int Nproc_max=40;
 
@@ -71,6 +92,60 @@ static void usage(char *argv[])
     fprintf(OUTMAN, "             Apply method to data in Name_Xi_In.\n");
 	manline();
 
+	fprintf(OUTMAN, "         [-H ]\n");
+    fprintf(OUTMAN, "             Write for each point of the grid the histogram of the statistic\n");
+    fprintf(OUTMAN, "             (range and bin size in the param file) instead of all its values.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-a Rel_Err]\n");
+    fprintf(OUTMAN, "             Adaptive number of simulations (H0 only, implies -H): each point\n");
+    fprintf(OUTMAN, "             stops when its tail probability at the observed statistic is known\n");
+    fprintf(OUTMAN, "             to Rel_Err times the largest one of the grid (at most n_simu).\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-x Stat_Obs]\n");
+    fprintf(OUTMAN, "             Observed statistic for -a, default is the value written by -d.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-S IS_Shift]\n");
+    fprintf(OUTMAN, "             Importance sampling (H0 only, implies -H): half of the simulations\n");
+    fprintf(OUTMAN, "             have their mean moved by IS_Shift times the difference between the\n");
+    fprintf(OUTMAN, "             BAO and noBAO models at one alpha of the fitting grid, the histograms\n");
+    fprintf(OUTMAN, "             are weighted. IS_Shift=0.5 is a good choice.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-f Fit_Sub]\n");
+    fprintf(OUTMAN, "             Fitting grid with Fit_Sub points per step of Omega_m h^2 and alpha,\n");
+    fprintf(OUTMAN, "             the models between the nodes of the tables are interpolated.\n");
+    fprintf(OUTMAN, "             Default is 1.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-m Fit_Tol]\n");
+    fprintf(OUTMAN, "             The best fit of the fitting grid is refined by Brent's method in alpha\n");
+    fprintf(OUTMAN, "             and Omega_m h^2 in turn (models interpolated between the nodes of the\n");
+    fprintf(OUTMAN, "             tables), up to Fit_Tol times the steps of the grid (e.g. 0.01).\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-V Check_Sub]\n");
+    fprintf(OUTMAN, "             With -m, also fit on the full grid with Check_Sub points per step (as\n");
+    fprintf(OUTMAN, "             -f Check_Sub) and print the differences between the minima.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-R] or [--resume]\n");
+    fprintf(OUTMAN, "             Start from the checkpoint written by an interrupted run with the\n");
+    fprintf(OUTMAN, "             same options (its seed is used), the output is the same as without\n");
+    fprintf(OUTMAN, "             interruption.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [--shard k/K]\n");
+    fprintf(OUTMAN, "             Only the points j of the hypothesis grid with j%%K=k (0<=k<K), written\n");
+    fprintf(OUTMAN, "             in a partial output '_shard<k>' merged by 'merge_shards'.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-I InitRandomVal]\n");
+    fprintf(OUTMAN, "             Value used for random value generator initialization.\n");
+	manline();
+
 	
     vm_usage();
     manline();    
@@ -82,23 +157,20 @@ static void usage(char *argv[])
  
 /*********************************************************************/
 
-void gauss(double sigma, double &x, double &y)    /* Recipes */
+/* Whitened models of the fitting grid (U[k],V[l]) (coordinates in steps of the tables, model m=k*na+l) */
+static void set_bank(ModelBank &bank, fltarray &iC, fltarray &model_all, const double *U, int no, const double *V, int na)
 {
-	//Create a 2D gaussian independent in x,y  => f(x,y)=1/(2*pi*sigma) e^-(x^2+y^2)/(2*sigma^2)
-    double v1,v2,r,fac;
-	
-    do {
-        v1=2.0*drand48()-1; 
-        v2=2.0*drand48()-1; 
-        r=v1*v1+v2*v2;
-	}
-    while(r>=1.0);
-    fac=sqrt(-2*sigma*log((double) r)/r);
-    x=v1*fac;
-    y=v2*fac;
+	double *model=new double[model_all.nz()];
+	bank.alloc(iC, no*na);
+	for(int k=0; k<no; k++)
+		for(int l=0; l<na; l++)
+		{
+			interp_model(model_all, U[k], V[l], model);
+			bank.set_model(k*na+l, model);
+		}
+	delete [] model;
 }
 
-
 /*********************************************************************/
 
 /* GET PARAMETERS */
@@ -136,6 +208,8 @@ void get_param()
 	ret=fscanf(File, "%s\t%lf\n\n", Temp, &n_simu);
 
 	ret=fscanf(File, "%s\t%s\n", Temp, Name_Histo_Out_Prefix);
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &Histo_Min, &Histo_Max, &Histo_Bin);	//min, max, bin size of the streaming histograms (optional)
+	if(ret==4) Histo_Param=True;
 	
 	fclose(File);
 }
@@ -173,6 +247,92 @@ static void filtinit(int argc, char *argv[])
 				Data=True;
 				h=-1;
 				break;
+			case 'H': Histo = True;break;
+			case 'a': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -a.\n"); exit(-1);
+				}
+				Rel_Err=atof(argv[++i]);
+				if(Rel_Err<=0)
+				{
+					fprintf(OUTMAN, "Error: bad value for -a: %s\n",argv[i]); exit(-1);
+				}
+				Adapt=True;
+				break;
+			case 'x': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -x.\n"); exit(-1);
+				}
+				Stat_Obs=atof(argv[++i]);
+				Stat_Obs_Set=True;
+				break;
+			case 'S': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -S.\n"); exit(-1);
+				}
+				IS_Shift=atof(argv[++i]);
+				Import=True;
+				break;
+			case 'I': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -I.\n"); exit(-1);
+				}
+				seed=atol(argv[++i]);
+				break;
+			case 'f': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -f.\n"); exit(-1);
+				}
+				Fit_Sub=atoi(argv[++i]);
+				if(Fit_Sub<1)
+				{
+					fprintf(OUTMAN, "Error: bad value for -f: %s\n",argv[i]); exit(-1);
+				}
+				break;
+			case 'm': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -m.\n"); exit(-1);
+				}
+				Fit_Tol=atof(argv[++i]);
+				if(Fit_Tol<=0)
+				{
+					fprintf(OUTMAN, "Error: bad value for -m: %s\n",argv[i]); exit(-1);
+				}
+				Minimise=True;
+				break;
+			case 'V': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -V.\n"); exit(-1);
+				}
+				Check_Sub=atoi(argv[++i]);
+				if(Check_Sub<1)
+				{
+					fprintf(OUTMAN, "Error: bad value for -V: %s\n",argv[i]); exit(-1);
+				}
+				break;
+			case 'R': Resume = True;break;
+			case '-': 
+				if(strcmp(argv[i],"--resume")==0) Resume = True;
+				else if(strcmp(argv[i],"--shard")==0)
+				{
+					if(i+1==argc) 
+					{
+						fprintf(OUTMAN, "Error: no argument for --shard.\n"); exit(-1);
+					}
+					if(sscanf(argv[++i], "%d/%d", &Shard, &NShard)!=2 || NShard<1 || Shard<0 || Shard>=NShard)
+					{
+						fprintf(OUTMAN, "Error: bad value for --shard: %s\n",argv[i]); exit(-1);
+					}
+				}
+				else usage(argv);
+				break;
 			case 'c': VarCov = True;break;
 			case 'v': Verbose = True;break;
 			case '?': usage(argv); break;
@@ -198,6 +358,9 @@ static void filtinit(int argc, char *argv[])
 
 int main(int argc, char *argv[])
 {
+	/* Random init (changed with -I) */
+	seed = time(NULL);
+	
      /* Get command line arguments, open input file(s) if necessary */
     filtinit(argc, argv);
 
@@ -219,6 +382,47 @@ int main(int argc, char *argv[])
 	if(h==0 && VarCov==True)	strcat(Name_Histo_Out, "Dchi2_varcov_h0.fits");
 	if(h==1 && VarCov==False)	strcat(Name_Histo_Out, "Dchi2_h1.fits");
 	if(h==1 && VarCov==True)	strcat(Name_Histo_Out, "Dchi2_varcov_h1.fits");
+	if(Import==True)
+	{
+		if(h!=0 || Adapt==True)
+		{
+			fprintf(OUTMAN,"-S is only for the H0 hypothesis (-h 0), without -a.\n");
+			exit(-1);
+		}
+		Histo=True;
+	}
+	if(Check_Sub>0 && Minimise==False)
+	{
+		fprintf(OUTMAN,"-V checks the minimisation of -m.\n");
+		exit(-1);
+	}
+	if(Adapt==True)
+	{
+		if(h!=0)
+		{
+			fprintf(OUTMAN,"-a is only for the H0 hypothesis (-h 0).\n");
+			exit(-1);
+		}
+		if(Stat_Obs_Set==False)
+		{
+			char Name_Data_Obs[256];
+			sprintf(Name_Data_Obs, "../output_files/delta_chi2/Dchi2_data.fits");
+			fltarray stat_obs;
+			fits_read_fltarr(Name_Data_Obs, stat_obs);
+			Stat_Obs=stat_obs(0);
+		}
+		Histo=True;
+	}
+	if(Histo==True)
+	{
+		if(Histo_Param==False || Histo_Bin<=0 || Histo_Max<=Histo_Min)
+		{
+			fprintf(OUTMAN,"-H needs a line Histo(min,max,binsize) with min<max and binsize>0 at the end of the param file.\n");
+			exit(-1);
+		}
+		strcpy(Name_Histo_Out+strlen(Name_Histo_Out)-5, "_histo.fits");
+	}
+	if(NShard>1) sprintf(Name_Histo_Out+strlen(Name_Histo_Out)-5, "_shard%d.fits", Shard);
 	
 	
 	//Read arrays
@@ -323,49 +527,78 @@ int main(int argc, char *argv[])
 		cout << "B (min,max,delta) used (min,max,delta) = ("<< B_min1 << " , " << B_max1 << " , " << delta_B << ")"<< endl << endl;
 		
 		cout << endl << endl << "FITTING RANGE: " << endl;
-		cout << "Omega_m h^2 grid used (min,max,delta) = ("<< o_min2 << " , " << o_max2 << " , " << delta_o << ")"<< endl ;
-		cout << "alpha grid used (min,max,delta) = ("<< a_min2 << " , " << a_max2 << " , " << delta_a << ")"<< endl;
+		cout << "Omega_m h^2 grid used (min,max,delta) = ("<< o_min2 << " , " << o_max2 << " , " << delta_o/Fit_Sub << ")"<< endl ;
+		cout << "alpha grid used (min,max,delta) = ("<< a_min2 << " , " << a_max2 << " , " << delta_a/Fit_Sub << ")"<< endl;
 		cout << "B grid used (min,max) = ("<< B_min2 << " , " << B_max2 << ")"<< endl << endl;
+		if(Minimise==True) cout << "Best fits refined up to " << Fit_Tol << " steps of the grid" << endl << endl;
 		
 		cout << "Number of simulations for each point = " << n_simu << endl << endl;
 		
 		cout << "Write histo in file " << Name_Histo_Out << endl << endl << endl;
     }
 	
+	//Whitened models of the fitting grid (the fits always use the constant covariance matrix),
+	//with -f the models between the nodes of the tables are interpolated
+	int nind_o2=oind_max2-oind_min2+1; 	int nind_a2=aind_max2-aind_min2+1;
+	int nfit_o=(nind_o2-1)*Fit_Sub+1; 	int nfit_a=(nind_a2-1)*Fit_Sub+1;
+	double *U_Fit=new double[nfit_o], *V_Fit=new double[nfit_a];
+	for(int k=0; k<nfit_o; k++) U_Fit[k]=(oind_min2+double(k)/Fit_Sub)*delta_oind;
+	for(int l=0; l<nfit_a; l++) V_Fit[l]=(aind_min2+double(l)/Fit_Sub)*delta_aind;
+	ModelBank bank_BAO, bank_noBAO;
+	set_bank(bank_BAO, iC, model_BAO_all, U_Fit, nfit_o, V_Fit, nfit_a);
+	set_bank(bank_noBAO, iC, model_noBAO_all, U_Fit, nfit_o, V_Fit, nfit_a);
+	double B_fit_min=B_min2/B_model, B_fit_max=B_max2/B_model;
+
+	//With -m, the models of the nodes of the tables for the minimisation, and with -V the models
+	//of the full scan
+	ContinuousFit fit_BAO, fit_noBAO;
+	ModelBank check_BAO, check_noBAO;
+	if(Minimise==True)
+	{
+		fit_BAO.alloc(bank_BAO, model_BAO_all, U_Fit, nfit_o, V_Fit, nfit_a);
+		fit_noBAO.alloc(bank_noBAO, model_noBAO_all, U_Fit, nfit_o, V_Fit, nfit_a);
+	}
+	if(Check_Sub>0)
+	{
+		int ncheck_o=(nind_o2-1)*Check_Sub+1, ncheck_a=(nind_a2-1)*Check_Sub+1;
+		double *U_Check=new double[ncheck_o], *V_Check=new double[ncheck_a];
+		for(int k=0; k<ncheck_o; k++) U_Check[k]=(oind_min2+double(k)/Check_Sub)*delta_oind;
+		for(int l=0; l<ncheck_a; l++) V_Check[l]=(aind_min2+double(l)/Check_Sub)*delta_aind;
+		set_bank(check_BAO, iC, model_BAO_all, U_Check, ncheck_o, V_Check, ncheck_a);
+		set_bank(check_noBAO, iC, model_noBAO_all, U_Check, ncheck_o, V_Check, ncheck_a);
+		delete [] U_Check; delete [] V_Check;
+	}
+	delete [] U_Fit; delete [] V_Fit;
+	long n_fit=0, n_eval=0;          //fits refined by -m and their chi^2
+	long n_check=0, n_worse=0;       //fits checked by -V, and above the full scan by more than CHECK_TOL
+	double check_max=-HUGE_VAL, check_sum=0.;
+	
 	//Delta chi2 for single xi data
 	if(Data==True)
 	{
-		fltarray model_BAO(nr);
-		fltarray model_noBAO(nr);
 		fltarray xi(nr);
 		fits_read_fltarr(Name_Xi_In, xi);
-		
-		dblarray chi2_noBAO(oind_max2-oind_min2+1,aind_max2-aind_min2+1) ;
-		dblarray chi2_BAO(oind_max2-oind_min2+1,aind_max2-aind_min2+1) ;	
-		double B;
-		
-		for(int oind2=oind_min2; oind2<=oind_max2; oind2++)
+		double *x=new double[nr], *wx=new double[nr];
+		for(int i=0;i<nr;i++) x[i]=xi(i);
+		double wx2=bank_BAO.whiten(x, wx);
+
+		int m_BAO=0, m_noBAO=0;
+		double chi2_BAO=bank_BAO.min_chi2(wx, wx2, B_fit_min, B_fit_max, &m_BAO);
+		double chi2_noBAO=bank_noBAO.min_chi2(wx, wx2, B_fit_min, B_fit_max, &m_noBAO);
+		if(Minimise==True)
 		{
-			for(int aind2=aind_min2; aind2<=aind_max2; aind2++)
+			chi2_BAO=fit_BAO.refine(wx, wx2, m_BAO, chi2_BAO, B_fit_min, B_fit_max, Fit_Tol, &n_eval);
+			chi2_noBAO=fit_noBAO.refine(wx, wx2, m_noBAO, chi2_noBAO, B_fit_min, B_fit_max, Fit_Tol, &n_eval);
+			if(Check_Sub>0)
 			{
-				for(int i=0;i<nr;i++) model_BAO(i)=model_BAO_all(oind2*delta_oind,aind2*delta_aind,i);
-				for(int i=0;i<nr;i++) model_noBAO(i)=model_noBAO_all(oind2*delta_oind,aind2*delta_aind,i);
-				
-				B=(xi*mult(iC,model_BAO)).total()/(model_BAO*mult(iC,model_BAO)).total() ; //bias giving best-fit \chi^2
-				if(B>B_max2/B_model) B=B_max2/B_model;
-				if(B<B_min2/B_model) B=B_min2/B_model;
-				chi2_BAO(oind2-oind_min2,aind2-aind_min2)=((xi-B*model_BAO)*mult(iC,xi-B*model_BAO)).total() ;
-
-				B=(xi*mult(iC,model_noBAO)).total()/(model_noBAO*mult(iC,model_noBAO)).total()  ; //bias giving best-fit \chi^2
-				if(B>B_max2/B_model) B=B_max2/B_model;
-				if(B<B_min2/B_model) B=B_min2/B_model;
-				chi2_noBAO(oind2-oind_min2,aind2-aind_min2)=((xi-B*model_noBAO)*mult(iC,xi-B*model_noBAO)).total();
-
+				cout << "BAO chi2: " << chi2_BAO << " (full scan: " << check_BAO.min_chi2(wx, wx2, B_fit_min, B_fit_max) << ")" << endl;
+				cout << "noBAO chi2: " << chi2_noBAO << " (full scan: " << check_noBAO.min_chi2(wx, wx2, B_fit_min, B_fit_max) << ")" << endl;
 			}
 		}
 
 		fltarray Dchi2_data(1);
-		Dchi2_data(0)=chi2_noBAO.min()-chi2_BAO.min() ;
+		Dchi2_data(0)=chi2_noBAO-chi2_BAO;
+		delete [] x; delete [] wx;
 		char Name_Data_Out[256];
 		sprintf(Name_Data_Out, "../output_files/delta_chi2/Dchi2_data.fits");
 		fits_write_fltarr(Name_Data_Out,Dchi2_data);
@@ -374,8 +607,58 @@ int main(int argc, char *argv[])
 	}
 	
 	//histogram under H0 or H1
-	fltarray Dchi2_histo(nind_o1*nind_a1*nind_B1*n_simu);
+	fltarray Dchi2_histo;
+	int nbin_histo=0;
+	//rows of the points of the shard, j=Shard+row*NShard (all the points without --shard)
+	int nrow=(nind_o1*nind_a1*nind_B1-Shard+NShard-1)/NShard;
+	if(nrow==0)
+	{
+		fprintf(OUTMAN,"--shard: more shards than points of the grid (%d).\n", nind_o1*nind_a1*nind_B1);
+		exit(-1);
+	}
+	if(Histo==False)
+	{
+		if(NShard==1) Dchi2_histo.alloc(nind_o1*nind_a1*nind_B1*n_simu);
+		else Dchi2_histo.alloc(n_simu, nrow);
+	}
+	else
+	{
+		//counts of the streaming histograms, one row per point
+		nbin_histo=histo_nbin(Histo_Min, Histo_Max, Histo_Bin);
+		Dchi2_histo.alloc(nbin_histo+2, nrow);
+	}
 	long int count=0;
+	
+	//simulations done and number of them above Stat_Obs for each point (adaptive mode)
+	long *N_Done=new long[nind_o1*nind_a1*nind_B1];
+	long *K_Tail=new long[nind_o1*nind_a1*nind_B1];
+	for(int j=0;j<nind_o1*nind_a1*nind_B1;j++) {N_Done[j]=0; K_Tail[j]=0;}
+	int nphase=(Adapt==True) ? 2 : 1;
+	double p_ref=0.;
+
+	//rounds finished by each point, and the checkpoints of this state
+	int *Round=new int[nind_o1*nind_a1*nind_B1];
+	for(int j=0;j<nind_o1*nind_a1*nind_B1;j++) Round[j]=0;
+	double Key[]={double(h), double(VarCov), double(Histo), double(Adapt), double(Import), n_simu, double(Shard), double(NShard),
+	              o_min1, o_max1, delta_o, a_min1, a_max1, delta_a, B_min1, B_max1, delta_B,
+	              o_min2, o_max2, a_min2, a_max2, B_min2, B_max2, B_model,
+	              Histo_Min, Histo_Max, Histo_Bin, Rel_Err, Stat_Obs, IS_Shift, double(Fit_Sub),
+	              double(Minimise), Fit_Tol, double(Check_Sub)};
+	Checkpoint Ckpt;
+	Ckpt.init(Name_Histo_Out, Key, sizeof(Key)/sizeof(double), &Dchi2_histo, 1, nind_o1*nind_a1*nind_B1, N_Done, K_Tail, Round, &p_ref, &seed);
+	if(Resume==True)
+	{
+		if(Ckpt.read())
+		{
+			int nfinished=0;
+			for(int j=Shard;j<nind_o1*nind_a1*nind_B1;j+=NShard) if(Round[j]==nphase) nfinished++;
+			printf("Resume from %s: %d/%d points finished, seed %ld\n", Ckpt.name(), nfinished, nrow, seed);
+		}
+		else printf("No checkpoint %s, start from the beginning\n", Ckpt.name());
+	}
+
+	//alphas of the shifts of the importance sampling: the fitting grid
+	int aind_is=aind_min2, na_is=nind_a2;
 
 	#ifdef _OPENMP
 		int Nproc=omp_get_num_procs();
@@ -390,94 +673,216 @@ int main(int argc, char *argv[])
 		int index_z;
 		
 		
-		//Create variables for the loop
+		//Create variables for the loop (no allocation in the loop)
 		long int histo_ind=0;
-		fltarray model0(nr,1);
-		fltarray model_BAO(nr,1);
-		fltarray model_noBAO(nr,1);
-
-		fltarray g(nr); //gaussian standard variable
-		fltarray xi(nr,1);
-
-		dblarray chi2_noBAO(oind_max2-oind_min2+1,aind_max2-aind_min2+1) ;
-		dblarray chi2_BAO(oind_max2-oind_min2+1,aind_max2-aind_min2+1) ;
-
-		double B,B1;
+		double *model0=new double[nr];
+		double *g=new double[nr]; //gaussian standard variable
+		RandStream R;             //random stream of the current point of the tables
+		double *MU=new double[na_is*nr];    //shifts of g for the importance sampling
+		double *MU2=new double[na_is];
+		double *A_mu=new double[nr*nr];
+		double *W=new double[SIMU_BATCH];   //weights of the simulations
+		float *Row=new float[nbin_histo+2];  //counts of the current point and round with -H
+		const float *sqrt_cov;
+
+		//batch of simulations: xi, whitened xi and their best fits
+		double *X=new double[SIMU_BATCH*nr];
+		double *WX=new double[SIMU_BATCH*nr];
+		double *WX2=new double[SIMU_BATCH];
+		double *Chi2_BAO=new double[SIMU_BATCH];
+		double *Chi2_noBAO=new double[SIMU_BATCH];
+		double *Work=new double[SIMU_BATCH*BANK_BLOCK];
+		int *Arg_BAO=new int[SIMU_BATCH];       //model of the best fit of the grid (-m)
+		int *Arg_noBAO=new int[SIMU_BATCH];
+		double *Scan=new double[SIMU_BATCH];    //best fit of the full scan (-V)
+		long n_fit_t=0, n_eval_t=0, n_check_t=0, n_worse_t=0;
+		double check_max_t=-HUGE_VAL, check_sum_t=0.;
+
+		double B1;
 	
-		//Start loop
-		#pragma omp for schedule(dynamic)
-		for(int j=0;j<nind_o1*nind_a1*nind_B1;j++)
+		//With -a, a first round of ADAPT_PILOT simulations for every point gives p_ref,
+		//then each point continues until adapt_converged (at most n_simu simulations)
+		for(int phase=0; phase<nphase; phase++)
 		{
-			int oind1=j/(nind_a1*nind_B1)+oind_min1;
-			int temp=j-(oind1-oind_min1)*(nind_a1*nind_B1);
-			int aind1=temp/nind_B1+aind_min1;
-			int Bind1=temp-(aind1-aind_min1)*nind_B1+Bind_min1;
-			
-			B1=B_table(Bind1*delta_Bind)/B_model;
-			index_z=na_table*oind1*delta_oind+aind1*delta_aind;
-			
-			#pragma omp critical
+			#pragma omp single
 			{
-				count++;
-				if(Verbose==True) cout << count << '/' << nind_o1*nind_a1*nind_B1 << endl ;
+				if(phase==1 && p_ref==0.)
+				{
+					for(int j=Shard;j<nind_o1*nind_a1*nind_B1;j+=NShard)
+						if(double(K_Tail[j])/N_Done[j]>p_ref) p_ref=double(K_Tail[j])/N_Done[j];
+					if(p_ref<1.0/n_simu) p_ref=1.0/n_simu;
+					printf("Largest tail probability after the first round: %g\n", p_ref);
+				}
+				count=0;
 			}
-			
-			//model for hypothesis H0 or H1
-			if(h==0)
-				for(int i=0;i<nr;i++) model0(i,0)=model_noBAO_all(oind1*delta_oind,aind1*delta_aind,i);
-			if(h==1)
-				for(int i=0;i<nr;i++) model0(i,0)=model_BAO_all(oind1*delta_oind,aind1*delta_aind,i); 
-			for(int sind=0; sind<n_simu; sind++)
+		
+			//Start loop
+			#pragma omp for schedule(dynamic)
+			for(int j=0;j<nind_o1*nind_a1*nind_B1;j++)
 			{
-				g.init();
-				int k=0;
-				double temp_x,temp_y;
-				while(k<=nr-1)
+				int oind1=j/(nind_a1*nind_B1)+oind_min1;
+				int temp=j-(oind1-oind_min1)*(nind_a1*nind_B1);
+				int aind1=temp/nind_B1+aind_min1;
+				int Bind1=temp-(aind1-aind_min1)*nind_B1+Bind_min1;
+			
+				B1=B_table(Bind1*delta_Bind)/B_model;
+				index_z=na_table*oind1*delta_oind+aind1*delta_aind;
+				if(VarCov==False) sqrt_cov=sC.buffer();
+				if(VarCov==True)  sqrt_cov=sC_all.buffer()+(long) index_z*nr*nr;
+			
+				//one stream per point (o,alpha,B) of the tables and one vector of the stream per simulation:
+				//the histogram only depends on the seed, whatever the number of threads
+				R.init(seed, ((uint64_t) (oind1*delta_oind)*na_table+aind1*delta_aind)*nB_table+Bind1*delta_Bind);
+			
+				progress(&count, nind_o1*nind_a1*nind_B1, Verbose==True);
+				if(j%NShard!=Shard || Round[j]>phase) continue;      //other shard, or finished before the checkpoint
+				int row=j/NShard;
+			
+				//model for hypothesis H0 or H1
+				if(h==0)
+					for(int i=0;i<nr;i++) model0[i]=model_noBAO_all(oind1*delta_oind,aind1*delta_aind,i);
+				if(h==1)
+					for(int i=0;i<nr;i++) model0[i]=model_BAO_all(oind1*delta_oind,aind1*delta_aind,i); 
+
+				//shifts mu_k of g, sqrt(C) mu_k = IS_Shift (xi_BAO-xi_noBAO) at the k-th alpha of the fitting grid,
+				//times B for the constant covariance matrix
+				if(Import==True)
 				{
-					gauss(1.0,temp_x,temp_y);
-					g(k)=temp_x; k++;
-					if(k<=nr-1) { g(k)=temp_y; k++;}
+					for(int i=0;i<nr*nr;i++) A_mu[i]=sqrt_cov[i];
+					if(!cholesky(A_mu, nr))
+					{
+						fprintf(OUTMAN,"Error: the square root of the covariance matrix is not positive definite.\n");
+						exit(-1);
+					}
+					for(int k=0;k<na_is;k++)
+					{
+						double *mu=MU+(long) k*nr;
+						int aind_k=(aind_is+k)*delta_aind;
+						for(int i=0;i<nr;i++) mu[i]=IS_Shift*(model_BAO_all(oind1*delta_oind,aind_k,i)-model_noBAO_all(oind1*delta_oind,aind_k,i));
+						if(VarCov==False) scal(nr, B1, mu);
+						chol_solve(A_mu, nr, mu);
+						MU2[k]=dot(nr, mu, mu);
+					}
 				}
-				
-				if(VarCov==False) xi=mult(sC,g);   //Gaussian of mean 0 and covariance C
-				if(VarCov==True)  xi=mult(sC_all,g,index_z);
-					
-				if(VarCov==False) xi+=B1*model0;      //Constant covariance matrix
-				if(VarCov==True)  xi=B1*(xi+model0);  //Varying covariance matrix					
-				
-				
-				for(int oind2=oind_min2; oind2<=oind_max2; oind2++)
+
+				//simulations of this round: [N_Done[j], n_end[, the state of the point is only
+				//updated at the end of the round (see Checkpoint)
+				long n_end=(Adapt==True && phase==0 && ADAPT_PILOT<n_simu) ? ADAPT_PILOT : (long) n_simu;
+				long n_done=N_Done[j], k_tail=K_Tail[j];
+				for(int i=0;i<nbin_histo+2;i++) Row[i]=0.;
+				for(long sind0=n_done; sind0<n_end; sind0+=SIMU_BATCH)
 				{
-					for(int aind2=aind_min2; aind2<=aind_max2; aind2++)
+					if(phase==1 && adapt_converged(k_tail, n_done, p_ref, Rel_Err)) break;
+					int nbatch=0;
+					for(long sind=sind0; sind<n_end && sind<sind0+SIMU_BATCH; sind++, nbatch++)
 					{
-						for(int i=0;i<nr;i++) model_BAO(i,0)=model_BAO_all(oind2*delta_oind,aind2*delta_aind,i);
-						for(int i=0;i<nr;i++) model_noBAO(i,0)=model_noBAO_all(oind2*delta_oind,aind2*delta_aind,i);
-
-						B=(xi*mult(iC,model_BAO)).total()/(model_BAO*mult(iC,model_BAO)).total(); //bias giving best-fit \chi^2 
-						if(B>B_max2/B_model) B=B_max2/B_model;
-						if(B<B_min2/B_model) B=B_min2/B_model;
-						chi2_BAO(oind2-oind_min2,aind2-aind_min2)=((xi-B*model_BAO)*mult(iC,xi-B*model_BAO)).total() ;
-
-						B=(xi*mult(iC,model_noBAO)).total()/(model_noBAO*mult(iC,model_noBAO)).total(); //bias giving best-fit \chi^2
-						if(B>B_max2/B_model) B=B_max2/B_model;
-						if(B<B_min2/B_model) B=B_min2/B_model;
-						chi2_noBAO(oind2-oind_min2,aind2-aind_min2)=((xi-B*model_noBAO)*mult(iC,xi-B*model_noBAO)).total();
+						double *xi=X+nbatch*nr;
+						R.set_counter((uint64_t) sind*(nr+nr%2)); //each vector uses nr+nr%2 numbers
+						R.gauss(g, nr);
+						if(Import==True)
+						{
+							if(sind%2==1) axpy(nr, 1., MU+(sind/2)%na_is*nr, g);    //odd simulations from the shifted proposals
+							W[nbatch]=is_weight(nr, na_is, MU, MU2, g);
+						}
+						matvec(nr, sqrt_cov, g, xi);   //Gaussian of mean 0 and covariance C
+					
+						if(VarCov==False) axpy(nr, B1, model0, xi);                   //Constant covariance matrix
+						if(VarCov==True)  {axpy(nr, 1., model0, xi); scal(nr, B1, xi);}  //Varying covariance matrix					
 					}
+
+					//best fits of the batch over the fitting grid with the whitened models
+					bank_BAO.whiten_batch(nbatch, X, WX, WX2);
+					bank_BAO.min_chi2_batch(nbatch, WX, WX2, B_fit_min, B_fit_max, Chi2_BAO, Work, (Minimise==True) ? Arg_BAO : NULL);
+					bank_noBAO.min_chi2_batch(nbatch, WX, WX2, B_fit_min, B_fit_max, Chi2_noBAO, Work, (Minimise==True) ? Arg_noBAO : NULL);
+
+					//with -m, each best fit of the grid is refined, and with -V compared to the full scan
+					if(Minimise==True)
+					{
+						for(int sind=0; sind<nbatch; sind++)
+						{
+							Chi2_BAO[sind]=fit_BAO.refine(WX+sind*nr, WX2[sind], Arg_BAO[sind], Chi2_BAO[sind], B_fit_min, B_fit_max, Fit_Tol, &n_eval_t);
+							Chi2_noBAO[sind]=fit_noBAO.refine(WX+sind*nr, WX2[sind], Arg_noBAO[sind], Chi2_noBAO[sind], B_fit_min, B_fit_max, Fit_Tol, &n_eval_t);
+						}
+						n_fit_t+=2*nbatch;
+					}
+					for(int c=0; c<2 && Check_Sub>0; c++)
+					{
+						const double *chi2=(c==0) ? Chi2_BAO : Chi2_noBAO;
+						((c==0) ? check_BAO : check_noBAO).min_chi2_batch(nbatch, WX, WX2, B_fit_min, B_fit_max, Scan, Work);
+						for(int sind=0; sind<nbatch; sind++)
+						{
+							double diff=chi2[sind]-Scan[sind];
+							if(diff>check_max_t) check_max_t=diff;
+							check_sum_t+=diff;
+							if(diff>CHECK_TOL) n_worse_t++;
+						}
+						n_check_t+=nbatch;
+					}
+
+					//each (point, simulation) has its own entry, or each point its row of counts with -H:
+					//the threads write disjoint slices
+					histo_ind=sind0+(long) n_simu*row;
+					if(Histo==False)
+					{
+						float *histo=Dchi2_histo.buffer()+histo_ind;
+						for(int sind=0; sind<nbatch; sind++)
+							histo[sind]=Chi2_noBAO[sind]-Chi2_BAO[sind]; 
+					}
+					else
+					{
+						for(int sind=0; sind<nbatch; sind++)
+							Row[histo_bin(Chi2_noBAO[sind]-Chi2_BAO[sind], Histo_Min, Histo_Bin, nbin_histo)]+=(Import==True) ? W[sind] : 1.;
+					}
+					n_done+=nbatch;
+					if(Adapt==True)
+						for(int sind=0; sind<nbatch; sind++)
+							if(Chi2_noBAO[sind]-Chi2_BAO[sind]>=Stat_Obs) k_tail++;
 				}
-				histo_ind=sind+n_simu*(Bind1-Bind_min1)+n_simu*nind_B1*(aind1-aind_min1)+n_simu*nind_B1*nind_a1*(oind1-oind_min1);
-				#pragma omp critical
+
+				//end of the round for this point
+				#pragma omp critical(checkpoint)
 				{
-					Dchi2_histo(histo_ind)=chi2_noBAO.min()-chi2_BAO.min(); 
-					//cout << chi2_noBAO.min() << " " << chi2_BAO.min() << "  ";
-					//if(chi2_noBAO.min()>chi2_BAO.min()) cout << sqrt(chi2_noBAO.min()-chi2_BAO.min())<< endl;
-					//else cout << endl;
+					if(Histo==True)
+					{
+						float *counts=Dchi2_histo.buffer()+(long) row*(nbin_histo+2);
+						for(int i=0;i<nbin_histo+2;i++) counts[i]+=Row[i];
+					}
+					N_Done[j]=n_done; K_Tail[j]=k_tail; Round[j]=phase+1;
+					if(Ckpt.due()) Ckpt.write();
 				}
 			}
 		}
+		#pragma omp critical(minimise)
+		{
+			n_fit+=n_fit_t; n_eval+=n_eval_t; n_check+=n_check_t; n_worse+=n_worse_t;
+			check_sum+=check_sum_t;
+			if(check_max_t>check_max) check_max=check_max_t;
+		}
+		delete [] model0; delete [] g; delete [] MU; delete [] MU2; delete [] A_mu; delete [] W; delete [] Row;
+		delete [] X; delete [] WX; delete [] WX2; delete [] Chi2_BAO; delete [] Chi2_noBAO; delete [] Work;
+		delete [] Arg_BAO; delete [] Arg_noBAO; delete [] Scan;
 	}
 						
 
+    if(Adapt==True)
+    {
+		double n_tot=0.;
+		for(int j=Shard;j<nind_o1*nind_a1*nind_B1;j+=NShard) n_tot+=N_Done[j];
+		printf("Simulations: %.0f (%.0f without -a)\n", n_tot, n_simu*nrow);
+    }
+    if(Minimise==True && n_fit>0)
+		printf("Minimisation: %.1f chi2 per fit after the scan of the %d models of the grid\n", double(n_eval)/n_fit, nfit_o*nfit_a);
+    if(n_check>0)
+    {
+		printf("Check with the full scan of %d models: chi2 above the scan by %g at most, %g on average\n", check_BAO.nmodel(), check_max, check_sum/n_check);
+		printf("%ld fits out of %ld above the scan by more than %g\n", n_worse, n_check, CHECK_TOL);
+    }
+    delete [] N_Done; delete [] K_Tail; delete [] Round;
+    
     // Write the histogram
-    fits_write_fltarr(Name_Histo_Out, Dchi2_histo);
+    if(NShard>1) write_shard(Name_Histo_Out, Dchi2_histo, Shard, NShard, Histo==True, Histo_Min, Histo_Bin);
+    else if(Histo==False) fits_write_fltarr(Name_Histo_Out, Dchi2_histo);
+    else write_histo(Name_Histo_Out, Dchi2_histo, Histo_Min, Histo_Bin);
+    Ckpt.remove();
     exit(0);
 }
@@ -0,0 +1,397 @@
+/*******************************************************
+Program: 'likelihood.cc'
+
+Posterior of (Omega_m h^2, alpha) for a measured correlation
+function xi, with a constant covariance matrix or with the
+model-dependent covariance matrix (-c), marginalized over the
+bias B with a flat prior on the B grid of likelihood.param. This
+is the C++ version of the idl procedure idl/likelihood.pro
+(without the contour plots).
+
+For the model xi_m of the point (o,alpha) of the tables and B in
+units of B_model, -2 log L is
+  a-2*B*b+B^2*c                                 (constant)
+  nr*2*log(B)+log_det+a/B^2-2*b/B+c             (model-dependent)
+with a=<xi,iC#xi>, b=<xi,iC#xi_m>, c=<xi_m,iC#xi_m>. The products
+iC#xi_m are computed once per point, so each value of B costs a
+few operations instead of a matrix product, and the sum over B is
+done on the logarithms (no underflow far from the maximum).
+
+The output is the posterior on the grid of the tables between the
+limits of likelihood.param, normalized to 1 ('post.fits', axes
+CRVAL1/CDELT1 for Omega_m h^2 and CRVAL2/CDELT2 for alpha), and
+the 1-sigma intervals of the marginal posteriors
+('interval.fits': alpha, sigma_alpha, Omega_m h^2, sigma_Omega_m h^2,
+with sigma the half-width around the maximum that contains 68.27%
+of the marginal posterior, as in the idl procedure).
+
+The input file has either one xi (nr values) or a batch of xi,
+one per row (nr x n_xi, e.g. the correlation functions of the
+mocks); the outputs then have one plane (row) per xi.
+
+Version history:
+
+  V. 0.1 (19/10/2026): Initial version.
+********************************************************/
+
+#include "Array.h"
+#include "IM_IO.h"
+#include "bao_tools.h"
+#include <omp.h>
+
+
+Bool VarCov=False;
+Bool Verbose=False;
+
+// (TO BE SET IN PARAM FILE)
+double o_min,o_max;					//Omega_m h^2
+double a_min,a_max;					//alpha
+double B_min,B_max,delta_B,B_model;	//B
+
+char Name_o_table[256]; char Name_a_table[256];
+
+char Name_Model_BAO_all[256];   //name for BAO model correlations
+char Name_Inverse_Cov_all[256];     //name for inverse model-dependent covariance matrix
+char Name_Log_Determ_Cov_all[256];   //name for log of determinant model-dependent covariance matrix
+char Name_Inverse_Cov[256];     //name for inverse convariance matrix
+
+char Name_Out_Prefix[256];		/* output file prefix name */
+char Name_Xi_In[256]; //Name of input correlation file(s)
+
+//maximum number of procs used for the loops
+int Nproc_max=40;
+
+
+static void usage(char *argv[])
+{
+    fprintf(OUTMAN, "Usage: %s options Name_Xi_In\n\n", argv[0]);
+    fprintf(OUTMAN, "   where options =  \n");
+
+    fprintf(OUTMAN, "         [-c]\n");
+    fprintf(OUTMAN, "             Use model-dependent covariance matrix.\n");
+    fprintf(OUTMAN, "             Default is constant covariance matrix.");
+    manline();
+
+    fprintf(OUTMAN, "   Name_Xi_In has one correlation function, or one per row (nr x n_xi).\n");
+    manline();
+
+    vm_usage();
+    manline();
+    verbose_usage();
+    manline();
+    manline();
+    exit(-1);
+}
+
+/*********************************************************************/
+
+/* GET PARAMETERS */
+
+void get_param()
+{
+	char Name_Param_File[256];
+	sprintf(Name_Param_File, "../param/likelihood.param");
+	FILE *File=fopen(Name_Param_File,"r");
+
+    if (File == NULL)
+    {
+		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
+		exit(-1);
+    }
+	char Temp[256];
+	int ret;
+	ret=fscanf(File, "%s\t%lf\t%lf\n", Temp, &o_min, &o_max);					//min, max in Omega_m h^2
+	ret=fscanf(File, "%s\t%lf\t%lf\n", Temp, &a_min, &a_max);					//min, max in alpha
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &B_min, &B_max, &delta_B);	//min, max, step in B
+	ret=fscanf(File, "%s\t%lf\n\n", Temp, &B_model);							//B model
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_a_table);
+	ret=fscanf(File, "%s\t%s\n\n", Temp, Name_o_table);
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Model_BAO_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Inverse_Cov_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Log_Determ_Cov_all);
+	ret=fscanf(File, "%s\t%s\n\n", Temp, Name_Inverse_Cov);
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Out_Prefix);
+
+	fclose(File);
+}
+
+
+/*********************************************************************/
+
+/* GET COMMAND LINE ARGUMENTS */
+static void filtinit(int argc, char *argv[])
+{
+	int i=1;
+	while(i<argc)
+	{
+		if(argv[i][0] != '-' ) break;
+
+		switch (argv[i][1])
+        {
+			case 'c': VarCov = True;break;
+			case 'v': Verbose = True;break;
+			case '?': usage(argv); break;
+			default: usage(argv); break;
+			}
+		i++;
+	}
+
+	if(i<argc) strcpy(Name_Xi_In, argv[i++]);
+	else usage(argv);
+
+	/* make sure there are not too many parameters */
+	if (i < argc)
+        {
+		fprintf(OUTMAN, "Too many parameters: %s ...\n", argv[i]);
+		exit(-1);
+	}
+}
+
+/*********************************************************************/
+
+/* 1-sigma interval of the marginal posterior P (n values, sum 1) as in idl/likelihood.pro:
+   the interval [ind-i,ind+i] around the maximum ind is widened until it contains 68.27%,
+   return ind and i */
+void interval(const double *P, int n, int *ind, int *width)
+{
+	int im=0;
+	for(int k=1;k<n;k++) if(P[k]>P[im]) im=k;
+	int i=0;
+	double t=P[im];
+	while(t<=0.6827 && (im-i>0 || im+i<n-1))
+	{
+		i++;
+		if(im-i>=0) t+=P[im-i];
+		if(im+i<n) t+=P[im+i];
+	}
+	*ind=im; *width=i;
+}
+
+//Header of an output with the parameters of the grid on the first two axes
+void write_grid(char *Name, fltarray &Out, double crval1, double cdelt1, double crval2, double cdelt2)
+{
+	fitsstruct Header;
+	initfield(&Header);
+	Header.bitpix = -32;
+	Header.width = Out.nx();
+	Header.height = Out.ny();
+	Header.naxis = Out.naxis();
+	Header.npix = Out.n_elem();
+	for(int i=0; i<Header.naxis; i++) Header.TabAxis[i] = Out.axis(i+1);
+	Header.crpixx = 1.;
+	Header.crvalx = crval1;
+	Header.cdeltx = cdelt1;
+	Header.crpixy = 1.;
+	Header.crvaly = crval2;
+	Header.cdelty = cdelt2;
+	fits_write_fltarr(Name, Out, &Header);
+}
+
+
+/***************/
+
+
+int main(int argc, char *argv[])
+{
+     /* Get command line arguments, open input file(s) if necessary */
+    filtinit(argc, argv);
+
+	/* Get parameters */
+	get_param();
+
+	if(o_min > o_max || a_min > a_max || B_min > B_max)
+	{
+		fprintf(OUTMAN,"minimum values of parameters must be less than maximum values.\n");
+		exit(-1);
+	}
+	if(delta_B<=0 || B_min<=0)
+	{
+		fprintf(OUTMAN,"B grid must have B_min>0 and delta>0.\n");
+		exit(-1);
+	}
+
+	char Name_Post_Out[256], Name_Interval_Out[256];
+	sprintf(Name_Post_Out, "%spost%s.fits", Name_Out_Prefix, (VarCov==True) ? "_varcov" : "");
+	sprintf(Name_Interval_Out, "%sinterval%s.fits", Name_Out_Prefix, (VarCov==True) ? "_varcov" : "");
+
+
+	//Read arrays
+	fltarray iC,iC_all,Log_DetermC_all,model_BAO_all,xi_in;
+	if(VarCov==True)
+	{
+		fits_read_fltarr(Name_Inverse_Cov_all, iC_all);
+		fits_read_fltarr(Name_Log_Determ_Cov_all, Log_DetermC_all);
+	}
+	else fits_read_fltarr(Name_Inverse_Cov, iC);
+	fits_read_fltarr(Name_Model_BAO_all, model_BAO_all);
+	fits_read_fltarr(Name_Xi_In, xi_in);
+
+	int nr=model_BAO_all.nz();
+	int nxi=(xi_in.naxis()==1) ? 1 : xi_in.ny();
+	if(xi_in.nx() != nr || xi_in.naxis()>2)
+	{
+		fprintf(OUTMAN,"Incompatible dimensions between models and correlation function(s).\n");
+		exit(-1);
+	}
+	if(VarCov==False && (nr != iC.nx() || nr != iC.ny()))
+	{
+		fprintf(OUTMAN,"Incompatible dimensions between models and covariance matrix.\n");
+		exit(-1);
+	}
+	if(VarCov==True && (nr != iC_all.nx() || nr != iC_all.ny() || iC_all.nz() != model_BAO_all.nx()*model_BAO_all.ny()))
+	{
+		fprintf(OUTMAN,"Incompatible dimensions between models and covariance matrix.\n");
+		exit(-1);
+	}
+
+	//read parameter table
+	fltarray o_table,a_table;
+	fits_read_fltarr(Name_o_table, o_table); fits_read_fltarr(Name_a_table, a_table);
+
+	int no_table=o_table.nx(); 	int na_table=a_table.nx();
+	if(no_table != model_BAO_all.nx() || na_table != model_BAO_all.ny())
+	{
+		cout <<"Incompatible dimensions between models and parameter tables" << endl;
+		exit(-1);
+	}
+	double delta_o_table=o_table(1)-o_table(0); double delta_a_table=a_table(1)-a_table(0);
+
+	//Find indices of the grid according to requested limits
+	int oind_min=round((o_min-o_table.min())/(delta_o_table)); int oind_max=round((o_max-o_table.min())/delta_o_table);
+	int aind_min=round((a_min-a_table.min())/(delta_a_table)); int aind_max=round((a_max-a_table.min())/delta_a_table);
+	if(oind_min<0 || oind_min >=no_table || oind_max<0 || oind_max >=no_table || \
+	   aind_min<0 || aind_min >=na_table || aind_max<0 || aind_max >=na_table)
+	{
+		cout << "Grid range out of limits" << endl; exit(-1);
+	}
+	int nind_o=oind_max-oind_min+1; 	int nind_a=aind_max-aind_min+1;
+	int nB=(int) floor((B_max-B_min)/delta_B+0.5)+1;
+
+	//Readjust parameter limits
+	o_min=o_table(oind_min); o_max=o_table(oind_max);
+	a_min=a_table(aind_min); a_max=a_table(aind_max);
+	B_max=B_min+(nB-1)*delta_B;
+
+
+	//Print parameters
+    if (Verbose == True)
+    {
+		cout << endl << endl << "LIKELIHOOD" << endl << endl;
+        if(VarCov==True) cout << "-Use non constant covariance matrix " << endl;
+		cout << "-Correlation function(s) in " << Name_Xi_In << " (" << nxi << ")" << endl;
+
+		cout << endl << endl << "PARAMETERS: " << endl << endl;
+		cout << "Omega_m h^2 grid used (min,max,delta) = ("<< o_min << " , " << o_max << " , " << delta_o_table << ")"<< endl;
+		cout << "alpha grid used (min,max,delta) = ("<< a_min << " , " << a_max << " , " << delta_a_table << ")"<< endl;
+		cout << "B grid used (min,max,delta) = ("<< B_min << " , " << B_max << " , " << delta_B << ")"<< endl << endl;
+
+		cout << "Write posterior in file " << Name_Post_Out << endl;
+		cout << "Write intervals in file " << Name_Interval_Out << endl << endl << endl;
+    }
+
+	//a=<xi,iC#xi> for the constant covariance matrix
+	double *Xi=new double[(long) nxi*nr];
+	for(long i=0;i<(long) nxi*nr;i++) Xi[i]=xi_in.buffer()[i];
+	double *A0=new double[nxi];
+	if(VarCov==False)
+		for(int x=0;x<nxi;x++) A0[x]=quadratic(nr, iC.buffer(), Xi+(long) x*nr);
+
+	//log of the posterior marginalized over B, LogL[x*nind_o*nind_a+aind*nind_o+oind]
+	double *LogL=new double[(long) nxi*nind_o*nind_a];
+	long int count=0;
+
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+		if(Verbose==True) printf("\n %u processors used for the loop \n\n",Nproc);
+	#endif
+
+	#pragma omp parallel default(shared) num_threads(Nproc)
+	{
+		double *model=new double[nr];
+		double *w=new double[nr];     //iC#xi_m
+		double *M2L=new double[nB];   //-2 log L on the B grid
+
+		#pragma omp for schedule(dynamic)
+		for(int j=0;j<nind_o*nind_a;j++)
+		{
+			int oind=j/nind_a+oind_min;
+			int aind=j%nind_a+aind_min;
+			int index_z=na_table*oind+aind;
+			const float *inv_cov=(VarCov==True) ? iC_all.buffer()+(long) index_z*nr*nr : iC.buffer();
+			double log_det=(VarCov==True) ? Log_DetermC_all(index_z) : 0.;
+
+			for(int i=0;i<nr;i++) model[i]=model_BAO_all(oind,aind,i);
+			matvec(nr, inv_cov, model, w);
+			double c=dot(nr, model, w);
+
+			for(int x=0;x<nxi;x++)
+			{
+				const double *xi=Xi+(long) x*nr;
+				double a=(VarCov==True) ? quadratic(nr, inv_cov, xi) : A0[x];
+				double b=dot(nr, xi, w);
+
+				double m2l_min=HUGE_VAL;
+				for(int k=0;k<nB;k++)
+				{
+					double B=(B_min+k*delta_B)/B_model;
+					if(VarCov==True) M2L[k]=2.0*nr*log(B)+log_det+a/(B*B)-2.0*b/B+c;
+					else M2L[k]=a-2.0*B*b+B*B*c;
+					if(M2L[k]<m2l_min) m2l_min=M2L[k];
+				}
+				double s=0.;
+				for(int k=0;k<nB;k++) s+=exp(-0.5*(M2L[k]-m2l_min));
+				LogL[(long) x*nind_o*nind_a+(aind-aind_min)*nind_o+oind-oind_min]=-0.5*m2l_min+log(s);
+			}
+			progress(&count, nind_o*nind_a, Verbose==True);
+		}
+		delete [] model; delete [] w; delete [] M2L;
+	}
+
+	//normalized posteriors and intervals of each xi
+	fltarray Post, Interval;
+	if(nxi==1) {Post.alloc(nind_o, nind_a); Interval.alloc(4);}
+	else {Post.alloc(nind_o, nind_a, nxi); Interval.alloc(4, nxi);}
+	double *Lo=new double[nind_o];
+	double *La=new double[nind_a];
+	for(int x=0;x<nxi;x++)
+	{
+		const double *logl=LogL+(long) x*nind_o*nind_a;
+		float *post=Post.buffer()+(long) x*nind_o*nind_a;
+		double lmax=-HUGE_VAL;
+		for(int j=0;j<nind_o*nind_a;j++) if(logl[j]>lmax) lmax=logl[j];
+		double s=0.;
+		for(int j=0;j<nind_o*nind_a;j++) s+=exp(logl[j]-lmax);
+
+		for(int i=0;i<nind_o;i++) Lo[i]=0.;
+		for(int k=0;k<nind_a;k++) La[k]=0.;
+		for(int k=0;k<nind_a;k++)
+			for(int i=0;i<nind_o;i++)
+			{
+				double p=exp(logl[k*nind_o+i]-lmax)/s;
+				post[k*nind_o+i]=p;
+				Lo[i]+=p; La[k]+=p;
+			}
+
+		int ind, width;
+		float *inter=Interval.buffer()+4*x;
+		interval(La, nind_a, &ind, &width);
+		inter[0]=a_table(aind_min+ind); inter[1]=width*delta_a_table;
+		interval(Lo, nind_o, &ind, &width);
+		inter[2]=o_table(oind_min+ind); inter[3]=width*delta_o_table;
+		if(nxi==1 || Verbose==True)
+		{
+			if(nxi>1) printf("xi %d\n", x);
+			printf("alpha: %g +- %g\n", inter[0], inter[1]);
+			printf("omega_m h^2: %g +- %g\n", inter[2], inter[3]);
+		}
+	}
+	delete [] Lo; delete [] La; delete [] LogL; delete [] Xi; delete [] A0;
+
+	write_grid(Name_Post_Out, Post, o_min, delta_o_table, a_min, delta_a_table);
+	fits_write_fltarr(Name_Interval_Out, Interval);
+    exit(0);
+}
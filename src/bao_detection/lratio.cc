@@ -22,6 +22,8 @@
 
 #include "Array.h"
 #include "IM_IO.h"
+#include "bao_tools.h"
+#include "RandStream.h"
 #include <omp.h>
 
 
@@ -49,6 +51,20 @@ double n_simu=2000;
  
 char Name_Histo_Out_Prefix[256];		/* output file prefix name */
 
+Bool Histo=False;    //streaming histograms instead of the statistic of every simulation (-H)
+double Histo_Min,Histo_Max,Histo_Bin;    //range and bin size of the streaming histograms
+Bool Histo_Param=False;
+Bool Adapt=False;    //adaptive number of simulations per point (-a)
+double Rel_Err;      //target error of the tail probabilities in the adaptive mode
+double Stat_Obs;     //observed statistic for the adaptive mode
+Bool Stat_Obs_Set=False;
+Bool Import=False;   //importance sampling of the H0 simulations (-S)
+double IS_Shift;     //shift of the proposal toward the BAO model
+Bool Resume=False;   //start from the checkpoint of an interrupted run (-R)
+int Shard=0, NShard=1;   //points j of the grid with j%NShard==Shard (--shard)
+int Fit_Sub=1;       //points of the fitting grid per step of the hypothesis grid (-f)
+long seed;    //seed of the random streams
+
 //maximum number of procs used for the loops
 int Nproc_max=40;
 
@@ -71,7 +87,52 @@ static void usage(char *argv[])
 	manline();
 	
 	fprintf(OUTMAN, "         [-d Name_Xi_In]\n");
-    fprintf(OUTMAN, "             Apply method to data in Name_Xi_In.\n");
+    fprintf(OUTMAN, "             Apply method to data in Name_Xi_In, the statistic is written in\n");
+    fprintf(OUTMAN, "             lratio_data.fits (lratio_varcov_data.fits with -c).\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-H ]\n");
+    fprintf(OUTMAN, "             Write for each point of the grid the histogram of the statistic\n");
+    fprintf(OUTMAN, "             (range and bin size in the param file) instead of all its values.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-a Rel_Err]\n");
+    fprintf(OUTMAN, "             Adaptive number of simulations (H0 only, implies -H): each point\n");
+    fprintf(OUTMAN, "             stops when its tail probability at the observed statistic is known\n");
+    fprintf(OUTMAN, "             to Rel_Err times the largest one of the grid (at most n_simu).\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-x Stat_Obs]\n");
+    fprintf(OUTMAN, "             Observed statistic for -a, default is the value written by -d\n");
+    fprintf(OUTMAN, "             with the same covariance matrix (with or without -c).\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-S IS_Shift]\n");
+    fprintf(OUTMAN, "             Importance sampling (H0 only, implies -H): half of the simulations\n");
+    fprintf(OUTMAN, "             have their mean moved by IS_Shift times the difference between the\n");
+    fprintf(OUTMAN, "             BAO and noBAO models at one alpha of the fitting grid, the histograms\n");
+    fprintf(OUTMAN, "             are weighted. IS_Shift=0.5 is a good choice.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-f Fit_Sub]\n");
+    fprintf(OUTMAN, "             Fitting grid with Fit_Sub points per step of Omega_m h^2 and alpha,\n");
+    fprintf(OUTMAN, "             the models and covariance matrices between the nodes of the tables\n");
+    fprintf(OUTMAN, "             are interpolated. Default is 1.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-R] or [--resume]\n");
+    fprintf(OUTMAN, "             Start from the checkpoint written by an interrupted run with the\n");
+    fprintf(OUTMAN, "             same options (its seed is used), the output is the same as without\n");
+    fprintf(OUTMAN, "             interruption.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [--shard k/K]\n");
+    fprintf(OUTMAN, "             Only the points j of the hypothesis grid with j%%K=k (0<=k<K), written\n");
+    fprintf(OUTMAN, "             in a partial output '_shard<k>' merged by 'merge_shards'.\n");
+	manline();
+
+	fprintf(OUTMAN, "         [-I InitRandomVal]\n");
+    fprintf(OUTMAN, "             Value used for random value generator initialization.\n");
 	manline();
 	
     vm_usage();
@@ -84,21 +145,7 @@ static void usage(char *argv[])
  
 /*********************************************************************/
 
-void gauss(double sigma, double &x, double &y)    /* Recipes */
-{
-	//Create a 2D gaussian independent in x,y  => f(x,y)=1/(2*pi*sigma) e^-(x^2+y^2)/(2*sigma^2)
-    double v1,v2,r,fac;
-	
-    do {
-        v1=2.0*drand48()-1; 
-        v2=2.0*drand48()-1; 
-        r=v1*v1+v2*v2;
-	}
-    while(r>=1.0);
-    fac=sqrt(-2*sigma*log((double) r)/r);
-    x=v1*fac;
-    y=v2*fac;
-}
+/*********************************************************************/
 
 /*********************************************************************/
 
@@ -136,6 +183,8 @@ void get_param()
 	ret=fscanf(File, "%s\t%lf\n\n", Temp, &n_simu);
 	
 	ret=fscanf(File, "%s\t%s\n", Temp, Name_Histo_Out_Prefix);
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &Histo_Min, &Histo_Max, &Histo_Bin);	//min, max, bin size of the streaming histograms (optional)
+	if(ret==4) Histo_Param=True;
 	
 	fclose(File);
 	
@@ -176,6 +225,69 @@ static void filtinit(int argc, char *argv[])
 				Data=True;
 				h=-1;
 				break;
+			case 'H': Histo = True;break;
+			case 'a': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -a.\n"); exit(-1);
+				}
+				Rel_Err=atof(argv[++i]);
+				if(Rel_Err<=0)
+				{
+					fprintf(OUTMAN, "Error: bad value for -a: %s\n",argv[i]); exit(-1);
+				}
+				Adapt=True;
+				break;
+			case 'x': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -x.\n"); exit(-1);
+				}
+				Stat_Obs=atof(argv[++i]);
+				Stat_Obs_Set=True;
+				break;
+			case 'S': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -S.\n"); exit(-1);
+				}
+				IS_Shift=atof(argv[++i]);
+				Import=True;
+				break;
+			case 'I': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -I.\n"); exit(-1);
+				}
+				seed=atol(argv[++i]);
+				break;
+			case 'f': 
+				if(i+1==argc) 
+				{
+					fprintf(OUTMAN, "Error: no argument for -f.\n"); exit(-1);
+				}
+				Fit_Sub=atoi(argv[++i]);
+				if(Fit_Sub<1)
+				{
+					fprintf(OUTMAN, "Error: bad value for -f: %s\n",argv[i]); exit(-1);
+				}
+				break;
+			case 'R': Resume = True;break;
+			case '-': 
+				if(strcmp(argv[i],"--resume")==0) Resume = True;
+				else if(strcmp(argv[i],"--shard")==0)
+				{
+					if(i+1==argc) 
+					{
+						fprintf(OUTMAN, "Error: no argument for --shard.\n"); exit(-1);
+					}
+					if(sscanf(argv[++i], "%d/%d", &Shard, &NShard)!=2 || NShard<1 || Shard<0 || Shard>=NShard)
+					{
+						fprintf(OUTMAN, "Error: bad value for --shard: %s\n",argv[i]); exit(-1);
+					}
+				}
+				else usage(argv);
+				break;
 			case 'v': Verbose = True;break;
 			case '?': usage(argv); break;
 			default: usage(argv); break;
@@ -199,9 +311,8 @@ static void filtinit(int argc, char *argv[])
 
 int main(int argc, char *argv[])
 {
-	/* Random init */
-	long seed = time(NULL);
-    srand48((long) seed);
+	/* Random init (changed with -I) */
+	seed = time(NULL);
 	
      /* Get command line arguments, open input file(s) if necessary */
     filtinit(argc, argv);
@@ -225,6 +336,42 @@ int main(int argc, char *argv[])
 	if(h==0 && VarCov==True)	strcat(Name_Histo_Out, "lratio_varcov_h0.fits");	
 	if(h==1 && VarCov==False)	strcat(Name_Histo_Out, "lratio_h1.fits");
 	if(h==1 && VarCov==True)	strcat(Name_Histo_Out, "lratio_varcov_h1.fits");
+	if(Import==True)
+	{
+		if(h!=0 || Adapt==True)
+		{
+			fprintf(OUTMAN,"-S is only for the H0 hypothesis (-h 0), without -a.\n");
+			exit(-1);
+		}
+		Histo=True;
+	}
+	if(Adapt==True)
+	{
+		if(h!=0)
+		{
+			fprintf(OUTMAN,"-a is only for the H0 hypothesis (-h 0).\n");
+			exit(-1);
+		}
+		if(Stat_Obs_Set==False)
+		{
+			char Name_Data_Obs[256];
+			sprintf(Name_Data_Obs, "../output_files/lratio/lratio_%sdata.fits", (VarCov==True) ? "varcov_" : "");
+			fltarray stat_obs;
+			fits_read_fltarr(Name_Data_Obs, stat_obs);
+			Stat_Obs=stat_obs(0);
+		}
+		Histo=True;
+	}
+	if(Histo==True)
+	{
+		if(Histo_Param==False || Histo_Bin<=0 || Histo_Max<=Histo_Min)
+		{
+			fprintf(OUTMAN,"-H needs a line Histo(min,max,binsize) with min<max and binsize>0 at the end of the param file.\n");
+			exit(-1);
+		}
+		strcpy(Name_Histo_Out+strlen(Name_Histo_Out)-5, "_histo.fits");
+	}
+	if(NShard>1) sprintf(Name_Histo_Out+strlen(Name_Histo_Out)-5, "_shard%d.fits", Shard);
 
 	
 	
@@ -323,92 +470,171 @@ int main(int argc, char *argv[])
 		
 		cout << "B (min,max,delta) requested (min,max,delta) = ("<< B_min << " , " << B_max << " , " << delta_B << ")"<< endl;
 		cout << "B (min,max,delta) used (min,max,delta) = ("<< B_min2 << " , " << B_max2 << " , " << delta_B2 << ")"<< endl << endl;
+		if(Fit_Sub>1) cout << "Fitting grid with " << Fit_Sub << " points per step of Omega_m h^2 and alpha" << endl << endl;
 		
 		cout << "Number of simulations for each point = " << n_simu << endl << endl;
 		
 		cout << "Write histo in file " << Name_Histo_Out << endl << endl << endl;
     }
 	
-	double B1,B2;
-	int index_z;
-	double a,b,c;
+	double B1;
+	double a,b;
+
+	//Models of the fitting grid (the hypothesis grid, with Fit_Sub points per step with -f): between
+	//the nodes of the tables the models and inverse covariance matrices are interpolated, with the
+	//log-determinants of the interpolated matrices
+	int nfit_o=(nind_o-1)*Fit_Sub+1; 	int nfit_a=(nind_a-1)*Fit_Sub+1;
+	int nmodel=nfit_o*nfit_a;
+	double *Model_BAO=new double[nmodel*nr];
+	double *Model_noBAO=new double[nmodel*nr];
+	const float **Inv_Cov=new const float*[nmodel];
+	double *Log_Det=new double[nmodel];
+	CovCache iC_cache;
+	if(VarCov==True) iC_cache.init(iC_all, Log_DetermC_all, no_table, na_table);
+	for(int k=0; k<nfit_o; k++)
+	{
+		for(int l=0; l<nfit_a; l++)
+		{
+			int m=k*nfit_a+l;
+			double u=(oind_min+double(k)/Fit_Sub)*delta_oind, v=(aind_min+double(l)/Fit_Sub)*delta_aind;
+			interp_model(model_BAO_all, u, v, Model_BAO+m*nr);
+			interp_model(model_noBAO_all, u, v, Model_noBAO+m*nr);
+			if(VarCov==True)
+			{
+				Inv_Cov[m]=iC_cache.plane(u, v, Log_Det+m);
+			}
+		}
+	}
+	if(Verbose==True && iC_cache.size()>0) cout << iC_cache.size() << " interpolated covariance matrices" << endl << endl;
+
+	//Whitened models of the fitting grid for the constant covariance matrix
+	ModelBank bank_BAO, bank_noBAO;
+	if(VarCov==False)
+	{
+		bank_BAO.alloc(iC, nmodel);
+		bank_noBAO.alloc(iC, nmodel);
+		for(int m=0;m<nmodel;m++)
+		{
+			bank_BAO.set_model(m, Model_BAO+m*nr);
+			bank_noBAO.set_model(m, Model_noBAO+m*nr);
+		}
+	}
+	double B_fit_min=B_min2/B_model, B_fit_max=B_max2/B_model;
+	
+	//c=<xi_m,iC#xi_m> only depends on the model: computed once for the run
+	double *C_BAO=NULL, *C_noBAO=NULL;
+	if(VarCov==True)
+	{
+		C_BAO=new double[nmodel];
+		C_noBAO=new double[nmodel];
+		for(int m=0;m<nmodel;m++)
+		{
+			C_BAO[m]=quadratic(nr, Inv_Cov[m], Model_BAO+m*nr);
+			C_noBAO[m]=quadratic(nr, Inv_Cov[m], Model_noBAO+m*nr);
+		}
+	}
 	
 	//Likelihood ratio for single xi data
 	if(Data==True)
 	{
-		fltarray model_BAO(nr,1);		fltarray model_BAO0(nr,1);
-		fltarray model_noBAO(nr,1);  	fltarray model_noBAO0(nr,1);
 		fltarray xi0(nr);
-		fltarray xi(nr,1);
 		fits_read_fltarr(Name_Xi_In, xi0);
-		for(int i=0;i<nr;i++) xi(i,0)=xi0(i);
+		double *xi=new double[nr];
+		for(int i=0;i<nr;i++) xi[i]=xi0(i);
 		
-		dblarray lnoBAO,lBAO;
-		lnoBAO.reform(oind_max-oind_min+1,aind_max-aind_min+1) ; lBAO.reform(oind_max-oind_min+1,aind_max-aind_min+1) ;
-
-		
-		
-		for(int oind2=oind_min; oind2<=oind_max; oind2++)
+		double lBAO_min=HUGE_VAL, lnoBAO_min=HUGE_VAL;
+		if(VarCov==False)
 		{
-			for(int aind2=aind_min; aind2<=aind_max; aind2++)
+			double *wx=new double[nr];
+			double wx2=bank_BAO.whiten(xi, wx);
+			lBAO_min=bank_BAO.min_chi2(wx, wx2, B_fit_min, B_fit_max);
+			lnoBAO_min=bank_noBAO.min_chi2(wx, wx2, B_fit_min, B_fit_max);
+			delete [] wx;
+		}
+		else
+		{
+			double *y=new double[nr];
+			for(int m=0;m<nmodel;m++)
 			{
-				for(int i=0;i<nr;i++) model_BAO0(i,0)=model_BAO_all(oind2*delta_oind,aind2*delta_aind,i);
-				for(int i=0;i<nr;i++) model_noBAO0(i,0)=model_noBAO_all(oind2*delta_oind,aind2*delta_aind,i);
-				model_BAO=model_BAO0;
-				model_noBAO=model_noBAO0;
-				index_z=na_table*oind2*delta_oind+aind2*delta_aind; //for varying covariance
+				//one product y=iC#xi gives a, and b for both models
+				matvec(nr, Inv_Cov[m], xi, y);
+				a=dot(nr, y, xi);
 
-				if(VarCov==False)
-				{
-					B2=(xi*mult(iC,model_BAO)).total()/(model_BAO*mult(iC,model_BAO)).total(); //bias giving best-fit \chi^2 
-					if(B2>B_max2/B_model) B2=B_max2/B_model;
-					if(B2<B_min2/B_model) B2=B_min2/B_model;
-					lBAO(oind2-oind_min,aind2-aind_min)=((xi-B2*model_BAO)*mult(iC,xi-B2*model_BAO)).total();
-					
-					B2=(xi*mult(iC,model_noBAO)).total()/(model_noBAO*mult(iC,model_noBAO)).total(); //bias giving best-fit \chi^2
-					if(B2>B_max2/B_model) B2=B_max2/B_model;
-					if(B2<B_min2/B_model) B2=B_min2/B_model;
-					lnoBAO(oind2-oind_min,aind2-aind_min)=((xi-B2*model_noBAO)*mult(iC,xi-B2*model_noBAO)).total();
-				}
-				else
-				{
-					//minimize 2*nr*log(B)+1/B^2*<xi-B*xi_m,iC#(xi-B*xi_m)>
-					//1/B root of equation |xi|^2_iC * X^2 - <xi,iC#xi_m> * X - nr=a*X^2-b*X-nr
-					//B=2*|xi|^2_iC / [ <xi,iC#xi_m> + sqrt( <xi,iC#xi_m>^2+4*nr*|xi|^2_iC)= 2*a/(b+sqrt(b^2+4*nr*a))
-					a=(xi*mult(iC_all,xi,index_z)).total();
-					b=(xi*mult(iC_all,model_BAO,index_z)).total();
-					c=(model_BAO*mult(iC_all,model_BAO,index_z)).total();
-					B2=2*a/(b+sqrt(b*b+4*nr*a)); //bias giving best-fit 
-					if(B2>B_max2/B_model) B2=B_max2/B_model;
-					if(B2<B_min2/B_model) B2=B_min2/B_model;
-					lBAO(oind2-oind_min,aind2-aind_min)=2.0*nr*log(B2)+Log_DetermC_all(index_z)+1.0/pow(B2,2.0)*a-1.0/B2*2.0*b+c;
-					
-					a=(xi*mult(iC_all,xi,index_z)).total();
-					b=(xi*mult(iC_all,model_noBAO,index_z)).total();
-					c=(model_noBAO*mult(iC_all,model_noBAO,index_z)).total();
-					B2=2*a/(b+sqrt(b*b+4*nr*a)); //bias giving best-fit 
-					if(B2>B_max2/B_model) B2=B_max2/B_model;
-					if(B2<B_min2/B_model) B2=B_min2/B_model;
-					lBAO(oind2-oind_min,aind2-aind_min)=2.0*nr*log(B2)+Log_DetermC_all(index_z)+1.0/pow(B2,2.0)*a-1.0/B2*2.0*b+c;
-				}
+				b=dot(nr, y, Model_BAO+m*nr);
+				double l=fit_varcov(nr, a, b, C_BAO[m], Log_Det[m], B_fit_min, B_fit_max);
+				if(l<lBAO_min) lBAO_min=l;
+
+				b=dot(nr, y, Model_noBAO+m*nr);
+				l=fit_varcov(nr, a, b, C_noBAO[m], Log_Det[m], B_fit_min, B_fit_max);
+				if(l<lnoBAO_min) lnoBAO_min=l;
 			}
+			delete [] y;
 		}
+		delete [] xi;
 
 		fltarray lratio_data(1);
-		lratio_data(0)=double(lnoBAO.min())-double(lBAO.min());
+		lratio_data(0)=lnoBAO_min-lBAO_min;
 
 		char Name_Data_Out[256];
-		sprintf(Name_Data_Out, "../output_files/lratio/lratio_data.fits");
+		sprintf(Name_Data_Out, "../output_files/lratio/lratio_%sdata.fits", (VarCov==True) ? "varcov_" : "");
 		fits_write_fltarr(Name_Data_Out,lratio_data);
 
 		exit(0);
 	}
 
 	//histogram under H0 or H1
-	fltarray lratio_histo(nind_o*nind_a*nind_B*n_simu); 
+	fltarray lratio_histo;
+	int nbin_histo=0;
+	//rows of the points of the shard, j=Shard+row*NShard (all the points without --shard)
+	int nrow=(nind_o*nind_a*nind_B-Shard+NShard-1)/NShard;
+	if(nrow==0)
+	{
+		fprintf(OUTMAN,"--shard: more shards than points of the grid (%d).\n", nind_o*nind_a*nind_B);
+		exit(-1);
+	}
+	if(Histo==False)
+	{
+		if(NShard==1) lratio_histo.alloc(nind_o*nind_a*nind_B*n_simu);
+		else lratio_histo.alloc(n_simu, nrow);
+	}
+	else
+	{
+		//counts of the streaming histograms, one row per point
+		nbin_histo=histo_nbin(Histo_Min, Histo_Max, Histo_Bin);
+		lratio_histo.alloc(nbin_histo+2, nrow);
+	} 
 	long int count=0;
+	
+	//simulations done and number of them above Stat_Obs for each point (adaptive mode)
+	long *N_Done=new long[nind_o*nind_a*nind_B];
+	long *K_Tail=new long[nind_o*nind_a*nind_B];
+	for(int j=0;j<nind_o*nind_a*nind_B;j++) {N_Done[j]=0; K_Tail[j]=0;}
+	int nphase=(Adapt==True) ? 2 : 1;
+	double p_ref=0.;
+
+	//rounds finished by each point, and the checkpoints of this state
+	int *Round=new int[nind_o*nind_a*nind_B];
+	for(int j=0;j<nind_o*nind_a*nind_B;j++) Round[j]=0;
+	double Key[]={double(h), double(VarCov), double(Histo), double(Adapt), double(Import), n_simu, double(Shard), double(NShard),
+	              o_min, o_max, delta_o, a_min, a_max, delta_a, B_min, B_max, delta_B, B_model,
+	              Histo_Min, Histo_Max, Histo_Bin, Rel_Err, Stat_Obs, IS_Shift, double(Fit_Sub)};
+	Checkpoint Ckpt;
+	Ckpt.init(Name_Histo_Out, Key, sizeof(Key)/sizeof(double), &lratio_histo, 1, nind_o*nind_a*nind_B, N_Done, K_Tail, Round, &p_ref, &seed);
+	if(Resume==True)
+	{
+		if(Ckpt.read())
+		{
+			int nfinished=0;
+			for(int j=Shard;j<nind_o*nind_a*nind_B;j+=NShard) if(Round[j]==nphase) nfinished++;
+			printf("Resume from %s: %d/%d points finished, seed %ld\n", Ckpt.name(), nfinished, nrow, seed);
+		}
+		else printf("No checkpoint %s, start from the beginning\n", Ckpt.name());
+	}
 
 
+	//alphas of the shifts of the importance sampling: the fitting grid
+	int aind_is=aind_min, na_is=nind_a;
+
 	#ifdef _OPENMP
 		int Nproc=omp_get_num_procs();
 		if(Nproc>Nproc_max) Nproc=Nproc_max;
@@ -416,122 +642,206 @@ int main(int argc, char *argv[])
 	#endif	
 
 	//Main loop for simu histogram
-    #pragma omp parallel default(shared) private(B1,B2,a,b,c) num_threads(Nproc)
+    #pragma omp parallel default(shared) private(B1,a,b) num_threads(Nproc)
     {
-		//Create variables for the loop
+		//Create variables for the loop (no allocation in the loop)
 		long int histo_ind=0;
-		fltarray model0(nr,1);
-		fltarray model_BAO(nr,1); 		fltarray model_BAO0(nr,1);
-		fltarray model_noBAO(nr,1); 	fltarray model_noBAO0(nr,1);
-		
-		fltarray g(nr); //gaussian standard variable
-		fltarray xi(nr,1);
-
-		int index_z1,index_z2;
-		dblarray lnoBAO,lBAO;	
-		lnoBAO.reform(oind_max-oind_min+1,aind_max-aind_min+1) ; lBAO.reform(oind_max-oind_min+1,aind_max-aind_min+1) ;
+		double *model0=new double[nr];
+		double *g=new double[nr]; //gaussian standard variable
+		RandStream R;             //random stream of the current point of the tables
+		double *MU=new double[na_is*nr];    //shifts of g for the importance sampling
+		double *MU2=new double[na_is];
+		double *A_mu=new double[nr*nr];
+		double *W=new double[SIMU_BATCH];   //weights of the simulations
+		float *Row=new float[nbin_histo+2];  //counts of the current point and round with -H
+		double *y=new double[nr]; //iC#xi for the varying covariance matrix
+		const float *sqrt_cov;
+
+		//batch of simulations: xi, and for the constant covariance matrix whitened xi and best fits
+		double *X=new double[SIMU_BATCH*nr];
+		double *WX=new double[SIMU_BATCH*nr];
+		double *WX2=new double[SIMU_BATCH];
+		double *Chi2_BAO=new double[SIMU_BATCH];
+		double *Chi2_noBAO=new double[SIMU_BATCH];
+		double *Work=new double[SIMU_BATCH*BANK_BLOCK];
+
+		int index_z1;
 		
 		
-		//Start loop
-		#pragma omp for schedule(dynamic)
-		for(int j=0;j<nind_o*nind_a*nind_B;j++)
+		//With -a, a first round of ADAPT_PILOT simulations for every point gives p_ref,
+		//then each point continues until adapt_converged (at most n_simu simulations)
+		for(int phase=0; phase<nphase; phase++)
 		{
-			int oind1=j/(nind_a*nind_B)+oind_min;
-			int temp=j-(oind1-oind_min)*(nind_a*nind_B);
-			int aind1=temp/nind_B+aind_min;
-			int Bind1=temp-(aind1-aind_min)*nind_B+Bind_min;
+			#pragma omp single
+			{
+				if(phase==1 && p_ref==0.)
+				{
+					for(int j=Shard;j<nind_o*nind_a*nind_B;j+=NShard)
+						if(double(K_Tail[j])/N_Done[j]>p_ref) p_ref=double(K_Tail[j])/N_Done[j];
+					if(p_ref<1.0/n_simu) p_ref=1.0/n_simu;
+					printf("Largest tail probability after the first round: %g\n", p_ref);
+				}
+				count=0;
+			}
+		
+			//Start loop
+			#pragma omp for schedule(dynamic)
+			for(int j=0;j<nind_o*nind_a*nind_B;j++)
+			{
+				int oind1=j/(nind_a*nind_B)+oind_min;
+				int temp=j-(oind1-oind_min)*(nind_a*nind_B);
+				int aind1=temp/nind_B+aind_min;
+				int Bind1=temp-(aind1-aind_min)*nind_B+Bind_min;
 
 			
-			B1=B_table(Bind1*delta_Bind)/B_model;
-			index_z1=na_table*oind1*delta_oind+aind1*delta_aind;
+				B1=B_table(Bind1*delta_Bind)/B_model;
+				index_z1=na_table*oind1*delta_oind+aind1*delta_aind;
+				if(VarCov==False) sqrt_cov=sC.buffer();
+				if(VarCov==True)  sqrt_cov=sC_all.buffer()+(long) index_z1*nr*nr;
 			
-			#pragma omp critical
-			{
-				count++; if(Verbose==True) cout << count << '/' << nind_o*nind_a*nind_B << endl ;
-			}
+				//one stream per point (o,alpha,B) of the tables and one vector of the stream per simulation:
+				//the histogram only depends on the seed, whatever the number of threads
+				R.init(seed, ((uint64_t) (oind1*delta_oind)*na_table+aind1*delta_aind)*nB_table+Bind1*delta_Bind);
 			
-			//hypothesis sampled
-			if(h==0)
-				for(int i=0;i<nr;i++) model0(i,0)=model_noBAO_all(oind1*delta_oind,aind1*delta_aind,i);
-			if(h==1)
-				for(int i=0;i<nr;i++) model0(i,0)=model_BAO_all(oind1*delta_oind,aind1*delta_aind,i); 
-			for(int sind=0; sind<n_simu; sind++)
-			{
-				lBAO=0*lBAO; lnoBAO=0*lnoBAO;
-				g=0*g;
-				int k=0;
-				double temp_x,temp_y;
-				while(k<=nr-1)
+				progress(&count, nind_o*nind_a*nind_B, Verbose==True);
+				if(j%NShard!=Shard || Round[j]>phase) continue;      //other shard, or finished before the checkpoint
+				int row=j/NShard;
+			
+				//hypothesis sampled
+				if(h==0)
+					for(int i=0;i<nr;i++) model0[i]=model_noBAO_all(oind1*delta_oind,aind1*delta_aind,i);
+				if(h==1)
+					for(int i=0;i<nr;i++) model0[i]=model_BAO_all(oind1*delta_oind,aind1*delta_aind,i); 
+
+				//shifts mu_k of g, sqrt(C) mu_k = IS_Shift (xi_BAO-xi_noBAO) at the k-th alpha of the fitting grid,
+				//times B for the constant covariance matrix
+				if(Import==True)
 				{
-					gauss(1.0,temp_x,temp_y);
-					g(k)=temp_x; k++;
-					if(k<=nr-1) {	g(k)=temp_y; k++;}
+					for(int i=0;i<nr*nr;i++) A_mu[i]=sqrt_cov[i];
+					if(!cholesky(A_mu, nr))
+					{
+						fprintf(OUTMAN,"Error: the square root of the covariance matrix is not positive definite.\n");
+						exit(-1);
+					}
+					for(int k=0;k<na_is;k++)
+					{
+						double *mu=MU+(long) k*nr;
+						int aind_k=(aind_is+k)*delta_aind;
+						for(int i=0;i<nr;i++) mu[i]=IS_Shift*(model_BAO_all(oind1*delta_oind,aind_k,i)-model_noBAO_all(oind1*delta_oind,aind_k,i));
+						if(VarCov==False) scal(nr, B1, mu);
+						chol_solve(A_mu, nr, mu);
+						MU2[k]=dot(nr, mu, mu);
+					}
 				}
 
-				if(VarCov==False) xi=mult(sC,g);   //Gaussian of mean 0 and covariance C
-				if(VarCov==True)  xi=mult(sC_all,g,index_z1); 
-					
-				if(VarCov==False) xi+=B1*model0;     //Constant covariance matrx
-				if(VarCov==True)  xi=B1*(xi+model0); //Varying covariance matrix
 
-				
-				for(int oind2=oind_min; oind2<=oind_max; oind2++)
+				//simulations of this round: [N_Done[j], n_end[, the state of the point is only
+				//updated at the end of the round (see Checkpoint)
+				long n_end=(Adapt==True && phase==0 && ADAPT_PILOT<n_simu) ? ADAPT_PILOT : (long) n_simu;
+				long n_done=N_Done[j], k_tail=K_Tail[j];
+				for(int i=0;i<nbin_histo+2;i++) Row[i]=0.;
+				for(long sind0=n_done; sind0<n_end; sind0+=SIMU_BATCH)
 				{
-					for(int aind2=aind_min; aind2<=aind_max; aind2++)
+					if(phase==1 && adapt_converged(k_tail, n_done, p_ref, Rel_Err)) break;
+					int nbatch=0;
+					for(long sind=sind0; sind<n_end && sind<sind0+SIMU_BATCH; sind++, nbatch++)
 					{
-						index_z2=na_table*oind2*delta_oind+aind2*delta_aind;
-						
-						for(int i=0;i<nr;i++) model_BAO0(i,0)=model_BAO_all(oind2*delta_oind,aind2*delta_aind,i);
-						for(int i=0;i<nr;i++) model_noBAO0(i,0)=model_noBAO_all(oind2*delta_oind,aind2*delta_aind,i);
-						for(int i=0;i<nr;i++) model_BAO(i,0)=model_BAO_all(oind2*delta_oind,aind2*delta_aind,i);
-						for(int i=0;i<nr;i++) model_noBAO(i,0)=model_noBAO_all(oind2*delta_oind,aind2*delta_aind,i);
-								
-						if(VarCov==False)
+						double *xi=X+nbatch*nr;
+						R.set_counter((uint64_t) sind*(nr+nr%2)); //each vector uses nr+nr%2 numbers
+						R.gauss(g, nr);
+						if(Import==True)
 						{
-							B2=(xi*mult(iC,model_BAO)).total()/(model_BAO*mult(iC,model_BAO)).total(); //bias giving best-fit \chi^2 
-							if(B2>B_max2/B_model) B2=B_max2/B_model;
-							if(B2<B_min2/B_model) B2=B_min2/B_model;
-							lBAO(oind2-oind_min,aind2-aind_min)=((xi-B2*model_BAO)*mult(iC,xi-B2*model_BAO)).total() ;
-							
-							B2=(xi*mult(iC,model_noBAO)).total()/(model_noBAO*mult(iC,model_noBAO)).total(); //bias giving best-fit \chi^2
-							if(B2>B_max2/B_model) B2=B_max2/B_model;
-							if(B2<B_min2/B_model) B2=B_min2/B_model;
-							lnoBAO(oind2-oind_min,aind2-aind_min)=((xi-B2*model_noBAO)*mult(iC,xi-B2*model_noBAO)).total();
+							if(sind%2==1) axpy(nr, 1., MU+(sind/2)%na_is*nr, g);    //odd simulations from the shifted proposals
+							W[nbatch]=is_weight(nr, na_is, MU, MU2, g);
 						}
-						else
+						matvec(nr, sqrt_cov, g, xi);   //Gaussian of mean 0 and covariance C
+
+						if(VarCov==False) axpy(nr, B1, model0, xi);                   //Constant covariance matrix
+						if(VarCov==True)  {axpy(nr, 1., model0, xi); scal(nr, B1, xi);}  //Varying covariance matrix
+					}
+
+					if(VarCov==False)
+					{
+						//best fits of the batch over the fitting grid with the whitened models
+						bank_BAO.whiten_batch(nbatch, X, WX, WX2);
+						bank_BAO.min_chi2_batch(nbatch, WX, WX2, B_fit_min, B_fit_max, Chi2_BAO, Work);
+						bank_noBAO.min_chi2_batch(nbatch, WX, WX2, B_fit_min, B_fit_max, Chi2_noBAO, Work);
+					}
+					else
+					{
+						for(int sind=0; sind<nbatch; sind++)
 						{
-							//minimize 2*nr*log(B)+1/B^2*<xi-B*xi_m,iC#(xi-B*xi_m)>
-							//1/B root of equation |xi|^2_iC * X^2 - <xi,iC#xi_m> * X - nr=a*X^2-b*X-nr
-							//B=2*|xi|^2_iC / [ <xi,iC#xi_m> + sqrt( <xi,iC#xi_m>^2+4*nr*|xi|^2_iC)= 2*a/(b+sqrt(b^2+4*nr*a))
-							a=(xi*mult(iC_all,xi,index_z2)).total();
-							b=(xi*mult(iC_all,model_BAO,index_z2)).total();
-							c=(model_BAO*mult(iC_all,model_BAO,index_z2)).total();
-							B2=2*a/(b+sqrt(b*b+4*nr*a)); //bias giving best-fit 
-							if(B2>B_max2/B_model) B2=B_max2/B_model;
-							if(B2<B_min2/B_model) B2=B_min2/B_model;
-							lBAO(oind2-oind_min,aind2-aind_min)=2.0*nr*log(B2)+Log_DetermC_all(index_z2)+1.0/pow(B2,2.0)*a-1.0/B2*2.0*b+c;
-
-							a=(xi*mult(iC_all,xi,index_z2)).total();
-							b=(xi*mult(iC_all,model_noBAO,index_z2)).total();
-							c=(model_noBAO*mult(iC_all,model_noBAO,index_z2)).total();
-							B2=2*a/(b+sqrt(b*b+4*nr*a)); //bias giving best-fit 
-							if(B2>B_max2/B_model) B2=B_max2/B_model;
-							if(B2<B_min2/B_model) B2=B_min2/B_model;
-							lnoBAO(oind2-oind_min,aind2-aind_min)=2.0*nr*log(B2)+Log_DetermC_all(index_z2)+1.0/pow(B2,2.0)*a-1.0/B2*2.0*b+c;
+							double *xi=X+sind*nr;
+							double lBAO_min=HUGE_VAL, lnoBAO_min=HUGE_VAL;
+							for(int m=0;m<nmodel;m++)
+							{
+								//one product y=iC#xi gives a, and b for both models
+								matvec(nr, Inv_Cov[m], xi, y);
+								a=dot(nr, y, xi);
+
+								b=dot(nr, y, Model_BAO+m*nr);
+								double l=fit_varcov(nr, a, b, C_BAO[m], Log_Det[m], B_fit_min, B_fit_max);
+								if(l<lBAO_min) lBAO_min=l;
+
+								b=dot(nr, y, Model_noBAO+m*nr);
+								l=fit_varcov(nr, a, b, C_noBAO[m], Log_Det[m], B_fit_min, B_fit_max);
+								if(l<lnoBAO_min) lnoBAO_min=l;
+							}
+							Chi2_BAO[sind]=lBAO_min;
+							Chi2_noBAO[sind]=lnoBAO_min;
 						}
 					}
+
+					//each (point, simulation) has its own entry, or each point its row of counts with -H:
+					//the threads write disjoint slices
+					histo_ind=sind0+(long) n_simu*row;
+					if(Histo==False)
+					{
+						float *histo=lratio_histo.buffer()+histo_ind;
+						for(int sind=0; sind<nbatch; sind++)
+							histo[sind]=Chi2_noBAO[sind]-Chi2_BAO[sind];
+					}
+					else
+					{
+						for(int sind=0; sind<nbatch; sind++)
+							Row[histo_bin(Chi2_noBAO[sind]-Chi2_BAO[sind], Histo_Min, Histo_Bin, nbin_histo)]+=(Import==True) ? W[sind] : 1.;
+					}
+					n_done+=nbatch;
+					if(Adapt==True)
+						for(int sind=0; sind<nbatch; sind++)
+							if(Chi2_noBAO[sind]-Chi2_BAO[sind]>=Stat_Obs) k_tail++;
 				}
-				#pragma omp critical
+
+				//end of the round for this point
+				#pragma omp critical(checkpoint)
 				{
-					histo_ind=sind+n_simu*(Bind1-Bind_min)+n_simu*nind_B*(aind1-aind_min)+n_simu*nind_B*nind_a*(oind1-oind_min);
-					lratio_histo(histo_ind)=double(lnoBAO.min())-double(lBAO.min());
+					if(Histo==True)
+					{
+						float *counts=lratio_histo.buffer()+(long) row*(nbin_histo+2);
+						for(int i=0;i<nbin_histo+2;i++) counts[i]+=Row[i];
+					}
+					N_Done[j]=n_done; K_Tail[j]=k_tail; Round[j]=phase+1;
+					if(Ckpt.due()) Ckpt.write();
 				}
 			}
 		}
+		delete [] model0; delete [] g; delete [] y; delete [] MU; delete [] MU2; delete [] A_mu; delete [] W; delete [] Row;
+		delete [] X; delete [] WX; delete [] WX2; delete [] Chi2_BAO; delete [] Chi2_noBAO; delete [] Work;
 	}
 						
 
+    if(Adapt==True)
+    {
+		double n_tot=0.;
+		for(int j=Shard;j<nind_o*nind_a*nind_B;j+=NShard) n_tot+=N_Done[j];
+		printf("Simulations: %.0f (%.0f without -a)\n", n_tot, n_simu*nrow);
+    }
+    delete [] N_Done; delete [] K_Tail; delete [] Round;
+    
     // Write the histogram
-    fits_write_fltarr(Name_Histo_Out, lratio_histo);
+    if(NShard>1) write_shard(Name_Histo_Out, lratio_histo, Shard, NShard, Histo==True, Histo_Min, Histo_Bin);
+    else if(Histo==False) fits_write_fltarr(Name_Histo_Out, lratio_histo);
+    else write_histo(Name_Histo_Out, lratio_histo, Histo_Min, Histo_Bin);
+    Ckpt.remove();
     exit(0);
 }
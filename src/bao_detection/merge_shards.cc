@@ -0,0 +1,182 @@
+/*******************************************************
+Program: 'merge_shards.cc'
+
+Merge the partial outputs of 'delta_chi2' or 'lratio' run with
+the option --shard k/K (k=0..K-1) into the output of a run
+without shards, e.g. on several nodes sharing a file system:
+
+  for k in 0 1 2 3; do delta_chi2 -h 0 -I 5 --shard $k/4 & done; wait
+  merge_shards Dchi2_h0.fits Dchi2_h0_shard*.fits
+
+The seed must be the same for all the shards, the merged output is
+then the same as the one of a single run (except with the adaptive
+mode -a, where the reference tail probability is the largest one
+of each shard).
+
+Each partial output has one row per point of its shard (the n_simu
+values of the statistic, or the counts of the histogram with -H),
+the point of the row r being j=CRVAL2+r*CDELT2 (see bao_tools.h).
+The K partial outputs are checked to cover the grid exactly once.
+The output of the histograms keeps their bins (CRVAL1, CDELT1).
+
+Version history:
+
+  V. 0.1 (19/10/2026): Initial version.
+********************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include "Array.h"
+#include "IM_IO.h"
+
+bool Verbose = false;
+
+char Name_Out[256];
+int NFile;
+char **Name_In;
+
+
+/***************************************************************************/
+
+static void usage(char *argv[])
+{
+
+  fprintf(stderr, "Usage: %s options out_file in_shard_file1 ... in_shard_fileK\n\n", argv[0]);
+  fprintf(stderr, "   where options = \n");
+
+  fprintf(stderr, "         [-v]\n");
+  fprintf(stderr, "             Verbose.\n\n");
+
+
+  fprintf(stderr, "\n");
+  exit(-1);
+}
+
+
+void get_args(int argc, char *argv[])
+{
+
+  /* Require arguments (need at least one) !! */
+  if(argc == 1){
+    usage(argv);
+  }
+  /* Start at i = 1 to skip the command name. */
+  int i=1;
+
+    /* Check for a switch (leading "-"). */
+
+  while(argv[i][0] == '-') {
+
+      /* Use the next character to decide what to do. */
+
+    switch (argv[i][1]) {
+
+    case 'v': Verbose = true;
+      break;
+
+    case '?': usage(argv);
+      break;
+
+    default:  usage(argv);
+      break;
+    }
+    i++;
+	if(i==argc) usage(argv);
+  }
+
+  if(i<argc-1){
+      strcpy(Name_Out, argv[i++]);
+      NFile=argc-i;
+      Name_In=argv+i;
+  }
+  else usage(argv);
+
+}
+
+/*********************************************************************/
+
+
+int main(int argc, char ** argv)
+{
+	get_args(argc,argv);
+
+	//partial outputs, File_Shard[k] is the file of the shard k
+	fltarray *Part=new fltarray[NFile];
+	fitsstruct *Header=new fitsstruct[NFile];
+	int *File_Shard=new int[NFile];
+	for(int k=0;k<NFile;k++) File_Shard[k]=-1;
+	long ngrid=0;
+	for(int f=0;f<NFile;f++)
+	{
+		fits_read_fltarr(Name_In[f], Part[f], Header+f);
+		int shard=(int) floor(Header[f].crvaly+0.5), nshard=(int) floor(Header[f].cdelty+0.5);
+		if(Part[f].naxis()!=2 || nshard!=NFile || shard<0 || shard>=NFile)
+		{
+			cerr << "Error: " << Name_In[f] << " is not one of " << NFile << " shards" << endl;
+			exit(-1);
+		}
+		if(File_Shard[shard]>=0)
+		{
+			cerr << "Error: " << Name_In[f] << " and " << Name_In[File_Shard[shard]] << " are the same shard" << endl;
+			exit(-1);
+		}
+		File_Shard[shard]=f;
+		ngrid+=Part[f].ny();
+	}
+
+	int f0=File_Shard[0];
+	int nx=Part[f0].nx();
+	bool histo=(Header[f0].cdeltx!=0.);
+	for(int k=0;k<NFile;k++)
+	{
+		//the shard k has the points k, k+K, ... of the grid
+		int f=File_Shard[k];
+		if(Part[f].nx()!=nx || Part[f].ny()!=(ngrid-k+NFile-1)/NFile || Header[f].crvalx!=Header[f0].crvalx || Header[f].cdeltx!=Header[f0].cdeltx)
+		{
+			cerr << "Error: " << Name_In[f] << " is not from the same run as " << Name_In[f0] << endl;
+			exit(-1);
+		}
+	}
+
+	if(Verbose)
+	{
+		printf("\n\n# PARAMETERS: \n\n");
+		printf("# Output = %s\n", Name_Out);
+		printf("# Shards = %d\n", NFile);
+		printf("# Points of the grid = %ld\n", ngrid);
+		if(histo) printf("# Histograms of %d bins\n\n", nx);
+		else printf("# Simulations per point = %d\n\n", nx);
+	}
+
+	//the row of the point j is in the shard j%K, row j/K
+	fltarray Out;
+	if(histo) Out.alloc(nx, ngrid);
+	else Out.alloc((long) nx*ngrid);
+	for(long j=0;j<ngrid;j++)
+	{
+		const float *row=Part[File_Shard[j%NFile]].buffer()+(j/NFile)*nx;
+		float *out=Out.buffer()+j*nx;
+		for(int i=0;i<nx;i++) out[i]=row[i];
+	}
+
+	if(histo)
+	{
+		fitsstruct HD;
+		initfield(&HD);
+		HD.bitpix = -32;
+		HD.width = Out.nx();
+		HD.height = Out.ny();
+		HD.naxis = Out.naxis();
+		HD.npix = Out.n_elem();
+		for(int i=0; i<HD.naxis; i++) HD.TabAxis[i] = Out.axis(i+1);
+		HD.crpixx = Header[f0].crpixx;
+		HD.crvalx = Header[f0].crvalx;
+		HD.cdeltx = Header[f0].cdeltx;
+		fits_write_fltarr(Name_Out, Out, &HD);
+	}
+	else fits_write_fltarr(Name_Out, Out);
+
+	delete [] Part; delete [] Header; delete [] File_Shard;
+	exit(0);
+}
@@ -0,0 +1,37 @@
+/***********************************************************
+**
+**    File:  	covmatrix.h
+**
+************************************************************
+**
+**  Model-dependent covariance matrix of the correlation
+**  function, used by 'mk_covmatrix' and 'transform_covmatrix'
+**
+**  The covariance matrix is a 4-D FITS file of axes
+**  (no, nalpha, nrout, nrout) as written by the idl procedure
+**  idl/mk_covmatrix.pro: element (i,j,k,l) is at index
+**  i + no*(j + nalpha*(k + nrout*l)).
+**
+************************************************************/
+
+
+#ifndef	_COVMATRIX_H_
+#define	_COVMATRIX_H_
+
+#include "IM_IO.h"
+
+#define COV_NAXIS 4
+
+//Read a FITS image of at most COV_NAXIS axes in a float buffer (allocated with new),
+//the size of the missing axes is set to 1
+float *fits_read_cov(char *File_Name, int *TabAxis);
+
+//Write a float buffer as a FITS image of COV_NAXIS axes
+void fits_write_cov(char *File_Name, float *Data, int *TabAxis);
+
+//Eigenvalues Eval[0..n-1] and eigenvectors (columns of Evec, Evec[k*n+m] is the
+//component k of the vector m) of the symmetric n x n matrix A (cyclic Jacobi
+//method), A is destroyed
+void eigen_sym(double *A, int n, double *Eval, double *Evec);
+
+#endif
@@ -0,0 +1,143 @@
+/*******************************************************
+File: 'covmatrix_tools.cc'
+
+FITS input/output of the 4-D model-dependent covariance
+matrix and eigendecomposition of symmetric matrices, shared
+by 'mk_covmatrix' and 'transform_covmatrix'.
+The fltarray class and fits_read_fltarr/fits_write_fltarr
+are limited to 3 axes, so the header is read and written
+here and the data with the conversion routines of IM_IO.
+********************************************************/
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include "IM_IO.h"
+#include "covmatrix.h"
+
+//data conversion routines of IM_IO.cc
+void readdataf(FILE *file, char *filename, int bitpix, int Nelem, float *ptr, float bscale, float bzero);
+void writedataf(FILE *file, char *filename, int bitpix, int Nelem, float *ptr, float bscale, float bzero);
+
+
+float *fits_read_cov(char *File_Name, int *TabAxis)
+{
+	FILE *File=fits_file_des_in(File_Name);
+	int nblock;
+	char *Head=readfitshead(File, File_Name, &nblock);
+
+	long naxis=0, bitpix=0, n;
+	float bscale=1., bzero=0.;
+	char Key[16];
+	fitsread(Head, (char*) "NAXIS   ", &naxis, H_INT, T_INT);
+	fitsread(Head, (char*) "BITPIX  ", &bitpix, H_INT, T_INT);
+	fitsread(Head, (char*) "BSCALE  ", &bscale, H_FLOAT, T_FLOAT);
+	fitsread(Head, (char*) "BZERO   ", &bzero, H_FLOAT, T_FLOAT);
+	if(naxis<1 || naxis>COV_NAXIS)
+	{
+		cerr << "Error: bad NAXIS keyword in " << File_Name << ", NAXIS must be between 1 and " << COV_NAXIS << endl;
+		exit(-1);
+	}
+
+	long npix=1;
+	for(int i=0;i<COV_NAXIS;i++)
+	{
+		TabAxis[i]=1;
+		if(i<naxis)
+		{
+			sprintf(Key, "NAXIS%-3d", i+1);
+			n=0;
+			fitsread(Head, Key, &n, H_INT, T_INT);
+			TabAxis[i]=n;
+		}
+		npix*=TabAxis[i];
+	}
+	free(Head);
+
+	float *Data=new float[npix];
+	readdataf(File, File_Name, bitpix, npix, Data, bscale, bzero);
+	fclose(File);
+	return Data;
+}
+
+/*********************************************************************/
+
+void fits_write_cov(char *File_Name, float *Data, int *TabAxis)
+{
+	FILE *File=fits_file_des_out(File_Name);
+	char Head[FBSIZE+1], Card[81];
+	int nc=0;
+	long npix=1;
+
+	memset(Head, ' ', FBSIZE);
+	sprintf(Card, "%-8s= %20s", "SIMPLE", "T");                 memcpy(Head+80*nc++, Card, strlen(Card));
+	sprintf(Card, "%-8s= %20d", "BITPIX", BP_FLOAT);            memcpy(Head+80*nc++, Card, strlen(Card));
+	sprintf(Card, "%-8s= %20d", "NAXIS", COV_NAXIS);            memcpy(Head+80*nc++, Card, strlen(Card));
+	for(int i=0;i<COV_NAXIS;i++)
+	{
+		sprintf(Card, "NAXIS%-3d= %20d", i+1, TabAxis[i]);      memcpy(Head+80*nc++, Card, strlen(Card));
+		npix*=TabAxis[i];
+	}
+	sprintf(Card, "%-8s", "END");                               memcpy(Head+80*nc++, Card, strlen(Card));
+
+	if(fwrite(Head, 1, FBSIZE, File)!=(size_t) FBSIZE)
+	{
+		cerr << "Error: cannot write file " << File_Name << endl;
+		exit(-1);
+	}
+	writedataf(File, File_Name, BP_FLOAT, npix, Data, 1., 0.);
+	fclose(File);
+}
+
+/*********************************************************************/
+
+void eigen_sym(double *A, int n, double *Eval, double *Evec)
+{
+	int k, l, m;
+	for(k=0;k<n;k++)
+		for(l=0;l<n;l++) Evec[k*n+l]=(k==l) ? 1. : 0.;
+
+	for(int sweep=0;sweep<100;sweep++)
+	{
+		double off=0., diag=0.;
+		for(k=0;k<n;k++)
+		{
+			diag+=A[k*n+k]*A[k*n+k];
+			for(l=k+1;l<n;l++) off+=A[k*n+l]*A[k*n+l];
+		}
+		if(off<=1e-30*diag) break;
+
+		for(k=0;k<n-1;k++)
+			for(l=k+1;l<n;l++)
+			{
+				double akl=A[k*n+l];
+				if(akl==0.) continue;
+
+				//rotation in the plane (k,l) cancelling A(k,l)
+				double theta=0.5*(A[l*n+l]-A[k*n+k])/akl;
+				double t=1./(fabs(theta)+sqrt(theta*theta+1.));
+				if(theta<0.) t=-t;
+				double c=1./sqrt(t*t+1.), s=t*c;
+
+				for(m=0;m<n;m++)
+				{
+					double amk=A[m*n+k], aml=A[m*n+l];
+					A[m*n+k]=c*amk-s*aml;
+					A[m*n+l]=s*amk+c*aml;
+				}
+				for(m=0;m<n;m++)
+				{
+					double akm=A[k*n+m], alm=A[l*n+m];
+					A[k*n+m]=c*akm-s*alm;
+					A[l*n+m]=s*akm+c*alm;
+				}
+				for(m=0;m<n;m++)
+				{
+					double vmk=Evec[m*n+k], vml=Evec[m*n+l];
+					Evec[m*n+k]=c*vmk-s*vml;
+					Evec[m*n+l]=s*vmk+c*vml;
+				}
+			}
+	}
+	for(k=0;k<n;k++) Eval[k]=A[k*n+k];
+}
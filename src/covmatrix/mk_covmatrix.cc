@@ -0,0 +1,440 @@
+/*******************************************************
+Program: 'mk_covmatrix.cc'
+
+Compute the model-dependent covariance matrix of the
+correlation function from the alpha-dependent pair counts of
+the lognormal simulations (output of 'cf_alpha' or
+'lognormal_cf_alpha'). This is the C++ version of the idl
+procedure idl/mk_covmatrix.pro.
+
+For each Omega_m h^2 value of the simulations, the pair counts
+DD, RR, DR of each simulation and each alpha are rebinned in
+the bins rout and the Landy-Szalay estimator (DD-2DR)/RR+1 is
+computed. The mean and the covariance matrix over the
+simulations are then accumulated for each alpha. The covariance
+matrix is finally interpolated linearly on a finer Omega_m h^2
+table and written as a 4-D FITS file (see covmatrix.h).
+
+The rebinning coefficients depend only on the r binning of the
+cf_alpha files, they are computed once from the first file.
+The simulations are read one at a time and split in blocks
+processed in parallel: each block has its own mean and
+co-moment (Welford update), and the blocks are merged in order
+(Chan et al. formula), so the result does not depend on the
+number of threads.
+
+Version history:
+
+  V. 0.1 (19/10/2026): Initial version.
+********************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include "Array.h"
+#include "IM_IO.h"
+#include "covmatrix.h"
+#include <omp.h>
+
+#define SIMU_BLOCK 25       //number of simulations in a block of the parallel loop
+
+bool Verbose = false;
+
+char Name_Prefix[256];      //the simulation j of the Omega_m h^2 index i is Name_Prefix+i+Separator+j+'.fits'
+char Name_Cov_Out[256];
+char Separator[16]="-";
+
+//parameters set in mk_covmatrix.param
+double rout_min, rout_max;  //centers of the first and last bins
+int nrout;
+int no1;                    //number of Omega_m h^2 values of the simulations
+int no;                     //number of Omega_m h^2 values of the output covariance matrix
+int nsimu;                  //number of simulations for each Omega_m h^2 value
+
+int nr, nalpha;             //binning of the cf_alpha files
+float *R_Table;             //r(ir,ia) of the first file
+
+//sparse rebinning matrix: bin l of alpha a is the sum of W_Coeff[w]*counts(W_Ind[w],a)
+//for W_Start[a*nrout+l] <= w < W_Start[a*nrout+l+1]
+std::vector<int> W_Start;
+std::vector<int> W_Ind;
+std::vector<double> W_Coeff;
+
+//maximum number of procs used for the loops
+int Nproc_max=40;
+
+
+/* Mean and co-moment of the estimators for each alpha */
+struct CovAcc {
+	long n;
+	std::vector<double> Mean;   //Mean[a*nrout+k]
+	std::vector<double> M2;     //M2[(a*nrout+k)*nrout+l], sum of the products of the deviations
+
+	void alloc() {Mean.resize(nalpha*nrout); M2.resize(nalpha*nrout*nrout); reset();}
+	void reset()
+	{
+		n=0;
+		for(size_t i=0;i<Mean.size();i++) Mean[i]=0.;
+		for(size_t i=0;i<M2.size();i++) M2[i]=0.;
+	}
+};
+
+
+/***************************************************************************/
+
+static void usage(char *argv[])
+{
+
+  fprintf(stderr, "Usage: %s options in_Prefix out_Cov_file\n\n", argv[0]);
+  fprintf(stderr, "   The simulation j of the Omega_m h^2 index i is in_Prefix+i+'-'+j+'.fits'\n\n");
+  fprintf(stderr, "   where options = \n");
+
+  fprintf(stderr, "         [-S Separator]\n");
+  fprintf(stderr, "             Separator between i and j in the simulation names.\n");
+  fprintf(stderr, "             Default is '-', use '_' for the outputs of lognormal_cf_alpha -n.\n\n");
+
+  fprintf(stderr, "         [-v]\n");
+  fprintf(stderr, "             Verbose.\n\n");
+
+
+  fprintf(stderr, "\n");
+  exit(-1);
+}
+
+
+void get_args(int argc, char *argv[])
+{
+
+  /* Require arguments (need at least one) !! */
+  if(argc == 1){
+    usage(argv);
+  }
+  /* Start at i = 1 to skip the command name. */
+  int i=1;
+
+    /* Check for a switch (leading "-"). */
+
+  while(argv[i][0] == '-') {
+
+      /* Use the next character to decide what to do. */
+
+    switch (argv[i][1]) {
+
+    case 'S':
+      strncpy(Separator, argv[++i], 15);
+      break;
+
+    case 'v': Verbose = true;
+      break;
+
+    case '?': usage(argv);
+      break;
+
+    default:  usage(argv);
+      break;
+    }
+    i++;
+	if(i==argc) usage(argv);
+  }
+
+  if(i<(argc)-1){
+      strcpy(Name_Prefix, argv[i++]);
+      strcpy(Name_Cov_Out, argv[i++]);
+  }
+  else usage(argv);
+
+  if(i < argc){
+    fprintf(stderr, "Too many parameters: %s ...\n", argv[i]);
+    usage(argv);
+  }
+
+}
+
+/*********************************************************************/
+
+/* GET PARAMETERS */
+
+void get_param()
+{
+	char Name_Param_File[256];
+	sprintf(Name_Param_File, "../param/mk_covmatrix.param");
+	FILE *File=fopen(Name_Param_File,"r");
+
+    if (File == NULL)
+    {
+		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
+		exit(-1);
+    }
+	char Temp[256];
+	double Val1, Val2, Val3, Val4;
+	int ret;
+	ret=fscanf(File, "%s\t%lf\t%lf\t%lf\n", Temp, &rout_min, &rout_max, &Val1);	//centers of the first and last bins, number of bins
+	ret=fscanf(File, "%s\t%lf\n", Temp, &Val2);									//number of Omega_m h^2 values of the simulations
+	ret=fscanf(File, "%s\t%lf\n", Temp, &Val3);									//number of Omega_m h^2 values of the output
+	ret=fscanf(File, "%s\t%lf\n", Temp, &Val4);									//number of simulations
+	nrout=(int) Val1; no1=(int) Val2; no=(int) Val3; nsimu=(int) Val4;
+	fclose(File);
+
+	if(nrout<2 || no1<1 || no<1 || nsimu<2 || (no1==1 && no>1))
+	{
+		cerr << "Error: bad values in " << Name_Param_File << endl;
+		exit(-1);
+	}
+}
+
+/*********************************************************************/
+
+void name_simu(char *Name, int i, int j)
+{
+	sprintf(Name, "%s%d%s%d.fits", Name_Prefix, i, Separator, j);
+}
+
+/*********************************************************************/
+
+/* Rebinning coefficients of the bins [rout-drout/2,rout+drout/2], the input
+   bin ir covers [0.5*(r(ir-1)+r(ir)),0.5*(r(ir)+r(ir+1))] as in mk_covmatrix.pro */
+
+void init_rebin(char *Name)
+{
+	double drout=(rout_max-rout_min)/double(nrout-1);
+	W_Start.resize(nalpha*nrout+1);
+	W_Ind.clear(); W_Coeff.clear();
+
+	for(int a=0;a<nalpha;a++)
+	{
+		float *r=R_Table+a*nr;
+		for(int l=0;l<nrout;l++)
+		{
+			double rout=rout_min+l*drout;
+			double rinf=rout-drout/2., rsup=rout+drout/2.;
+			W_Start[a*nrout+l]=W_Ind.size();
+
+			int ind=0;
+			while(ind<nr-2 && 0.5*((double) r[ind]+r[ind+1])<rinf) ind++;
+			if(0.5*((double) r[ind]+r[ind+1])<rinf || rinf<r[0]-0.5*(r[1]-r[0]))
+			{
+				cerr << "Error: the bin " << rout << " is out of the r range of " << Name << " for alpha index " << a << endl;
+				exit(-1);
+			}
+			W_Ind.push_back(ind);
+			W_Coeff.push_back((0.5*((double) r[ind]+r[ind+1])-rinf)/((double) r[ind+1]-r[ind]));
+
+			ind++;
+			while(ind<nr-1 && 0.5*((double) r[ind]+r[ind+1])<rsup)
+			{
+				W_Ind.push_back(ind);
+				W_Coeff.push_back(1.);
+				ind++;
+			}
+			if(ind==nr-1)
+			{
+				cerr << "Error: the bin " << rout << " is out of the r range of " << Name << " for alpha index " << a << endl;
+				exit(-1);
+			}
+			W_Ind.push_back(ind);
+			W_Coeff.push_back(1.-(0.5*((double) r[ind]+r[ind+1])-rsup)/((double) r[ind+1]-r[ind]));
+		}
+	}
+	W_Start[nalpha*nrout]=W_Ind.size();
+}
+
+/*********************************************************************/
+
+/* Read the first simulation: binning of the cf_alpha files and rebinning coefficients */
+
+void init_simu()
+{
+	char Name[256];
+	int TabAxis[COV_NAXIS];
+	name_simu(Name, 0, 0);
+	float *K=fits_read_cov(Name, TabAxis);
+	nr=TabAxis[0]; nalpha=TabAxis[1];
+	if(TabAxis[2]<4 || TabAxis[3]!=1 || nr<3)
+	{
+		cerr << "Error: " << Name << " is not an output of cf_alpha" << endl;
+		exit(-1);
+	}
+	R_Table=new float[nr*nalpha];
+	for(int i=0;i<nr*nalpha;i++) R_Table[i]=K[i];
+	delete [] K;
+	init_rebin(Name);
+}
+
+/*********************************************************************/
+
+/* Landy-Szalay estimator LS[a*nrout+l] of the simulation (i,j) */
+
+void read_simu(int i, int j, double *LS)
+{
+	char Name[256];
+	int TabAxis[COV_NAXIS];
+	name_simu(Name, i, j);
+	float *K=fits_read_cov(Name, TabAxis);
+	if(TabAxis[0]!=nr || TabAxis[1]!=nalpha || TabAxis[2]<4)
+	{
+		cerr << "Error: the dimensions of " << Name << " are not those of the first simulation" << endl;
+		exit(-1);
+	}
+	for(int ir=0;ir<nr*nalpha;ir++)
+		if(fabs(K[ir]-R_Table[ir])>1e-4*fabs(R_Table[ir]))
+		{
+			cerr << "Error: the r binning of " << Name << " is not that of the first simulation" << endl;
+			exit(-1);
+		}
+
+	long np=(long) nr*nalpha;
+	for(int a=0;a<nalpha;a++)
+	{
+		float *dd=K+np+a*nr, *rr=K+2*np+a*nr, *dr=K+3*np+a*nr;
+		for(int l=0;l<nrout;l++)
+		{
+			double dd2=0., rr2=0., dr2=0.;
+			for(int w=W_Start[a*nrout+l];w<W_Start[a*nrout+l+1];w++)
+			{
+				dd2+=W_Coeff[w]*dd[W_Ind[w]];
+				rr2+=W_Coeff[w]*rr[W_Ind[w]];
+				dr2+=W_Coeff[w]*dr[W_Ind[w]];
+			}
+			LS[a*nrout+l]=(dd2-2.*dr2)/rr2+1.;
+		}
+	}
+	delete [] K;
+}
+
+/*********************************************************************/
+
+/* Welford update of Acc with the estimators LS of one simulation */
+
+void add_simu(CovAcc &Acc, double *LS, double *Delta)
+{
+	Acc.n++;
+	double inv_n=1./double(Acc.n);
+	for(int a=0;a<nalpha;a++)
+	{
+		double *Mean=&Acc.Mean[a*nrout];
+		double *M2=&Acc.M2[a*nrout*nrout];
+		double *X=LS+a*nrout;
+		for(int k=0;k<nrout;k++)
+		{
+			Delta[k]=X[k]-Mean[k];
+			Mean[k]+=Delta[k]*inv_n;
+		}
+		//M2 += (x-old mean)(x-new mean)^T
+		for(int k=0;k<nrout;k++)
+			for(int l=0;l<nrout;l++)
+				M2[k*nrout+l]+=Delta[k]*(X[l]-Mean[l]);
+	}
+}
+
+/* Merge Acc2 in Acc */
+
+void merge_acc(CovAcc &Acc, CovAcc &Acc2)
+{
+	if(Acc2.n==0) return;
+	double n1=Acc.n, n2=Acc2.n, n=n1+n2;
+	for(int a=0;a<nalpha;a++)
+		for(int k=0;k<nrout;k++)
+		{
+			int ik=a*nrout+k;
+			double dk=Acc2.Mean[ik]-Acc.Mean[ik];
+			for(int l=0;l<nrout;l++)
+			{
+				int il=a*nrout+l;
+				double dl=Acc2.Mean[il]-Acc.Mean[il];
+				Acc.M2[ik*nrout+l]+=Acc2.M2[ik*nrout+l]+dk*dl*n1*n2/n;
+			}
+		}
+	for(size_t i=0;i<Acc.Mean.size();i++) Acc.Mean[i]+=(Acc2.Mean[i]-Acc.Mean[i])*n2/n;
+	Acc.n+=Acc2.n;
+}
+
+/*********************************************************************/
+
+int main(int argc, char ** argv)
+{
+	get_param();
+	get_args(argc,argv);
+
+	if(Verbose)
+	{
+		printf("\n\n# PARAMETERS: \n\n");
+		printf("# Input prefix = %s\n", Name_Prefix);
+		printf("# Output covariance matrix = %s\n", Name_Cov_Out);
+		printf("# rout = %f .. %f, nrout = %d\n", rout_min, rout_max, nrout);
+		printf("# Omega_m h^2 values: %d simulated, %d in output\n", no1, no);
+		printf("# Simulations per Omega_m h^2 value = %d\n\n", nsimu);
+	}
+
+	init_simu();
+	if(Verbose) printf("# cf_alpha files: nr = %d, nalpha = %d\n", nr, nalpha);
+
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+		if(Verbose) printf("\n %u processors used for the loop \n\n",Nproc);
+	#endif
+
+	//covariance matrices of the simulations Cov1[((i*nalpha+a)*nrout+k)*nrout+l]
+	long ncov=(long) nalpha*nrout*nrout;
+	std::vector<double> Cov1(no1*ncov);
+	int nblock=(nsimu+SIMU_BLOCK-1)/SIMU_BLOCK;
+
+	for(int i=0;i<no1;i++)
+	{
+		CovAcc Acc;
+		Acc.alloc();
+
+		int b;
+		#pragma omp parallel default(shared) private(b) num_threads(Nproc)
+		{
+			CovAcc Acc_Block;
+			Acc_Block.alloc();
+			std::vector<double> LS(nalpha*nrout), Delta(nrout);
+
+			#pragma omp for ordered schedule(dynamic)
+			for(b=0;b<nblock;b++)
+			{
+				Acc_Block.reset();
+				for(int j=b*SIMU_BLOCK;j<nsimu && j<(b+1)*SIMU_BLOCK;j++)
+				{
+					read_simu(i, j, &LS[0]);
+					add_simu(Acc_Block, &LS[0], &Delta[0]);
+				}
+				#pragma omp ordered
+				{
+					merge_acc(Acc, Acc_Block);
+					if(Verbose) printf("Omega_m h^2 index %d: %ld simulations\n", i, Acc.n);
+				}
+			}
+		}
+
+		for(long m=0;m<ncov;m++) Cov1[i*ncov+m]=Acc.M2[m]/double(Acc.n-1);
+	}
+
+	//linear interpolation in Omega_m h^2 and 4-D output of axes (no,nalpha,nrout,nrout)
+	float *Cov=new float[no*ncov];
+	for(int io=0;io<no;io++)
+	{
+		double x=(no==1) ? 0. : io*double(no1-1)/double(no-1);
+		int ind=(int) floor(x+1e-9);
+		double rest=x-ind;
+		if(ind>=no1-1) {ind=no1-1; rest=0.;}
+		if(rest<1e-9) rest=0.;
+		for(int a=0;a<nalpha;a++)
+			for(int k=0;k<nrout;k++)
+				for(int l=0;l<nrout;l++)
+				{
+					long m=((long) a*nrout+k)*nrout+l;
+					double c=Cov1[ind*ncov+m];
+					if(rest>0.) c=(1.-rest)*c+rest*Cov1[(ind+1)*ncov+m];
+					Cov[io+no*(a+nalpha*(k+(long) nrout*l))]=c;
+				}
+	}
+	int TabAxis[COV_NAXIS]={no, nalpha, nrout, nrout};
+	fits_write_cov(Name_Cov_Out, Cov, TabAxis);
+
+	delete [] Cov;
+	delete [] R_Table;
+	exit(0);
+}
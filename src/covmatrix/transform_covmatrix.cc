@@ -0,0 +1,249 @@
+/*******************************************************
+Program: 'transform_covmatrix.cc'
+
+Compute the transforms of the model-dependent covariance
+matrix (square root, inverse and log-determinant) used by the
+programs 'delta_chi2' and 'lratio'. This is the C++ version of
+the idl procedure idl/transform_covmatrix.pro.
+
+The input is the 4-D covariance matrix of axes
+(no, nalpha, nrout, nrout) written by 'mk_covmatrix'. The
+outputs have the layout read by 'delta_chi2' and 'lratio':
+the matrices of the grid point (i,j) are the plane i*nalpha+j
+of the (nrout, nrout, no*nalpha) arrays, and the log-determinant
+is the element i*nalpha+j of a 1-D array. As in the idl
+procedure, the log-determinant is that of C/mean(C0), with C0 the
+matrix at the middle of the grid, which only changes it by a
+constant. The square root and inverse at the middle of the grid
+are also written (constant covariance matrix).
+
+Each matrix is diagonalized once, C = V diag(l) V^T, and
+  sqrt(C) = V diag(sqrt(l)) V^T
+  C^-1    = V diag(1/l) V^T
+  log det(C/m) = sum log(l) - nrout log(m).
+The grid points are processed in parallel.
+
+Version history:
+
+  V. 0.1 (19/10/2026): Initial version. Unlike the idl procedure,
+         inverse_cov.fits is the inverse of the matrix at the middle
+         of the grid (the idl procedure wrote its square root).
+********************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include "Array.h"
+#include "IM_IO.h"
+#include "covmatrix.h"
+#include <omp.h>
+
+bool Verbose = false;
+
+char Name_Cov_In[256];
+
+//parameters set in transform_covmatrix.param
+char Name_Sqrt_Cov_all[256];
+char Name_Inverse_Cov_all[256];
+char Name_Log_Determ_Cov_all[256];
+char Name_Sqrt_Cov[256];
+char Name_Inverse_Cov[256];
+
+//maximum number of procs used for the loops
+int Nproc_max=40;
+
+
+/***************************************************************************/
+
+static void usage(char *argv[])
+{
+
+  fprintf(stderr, "Usage: %s options in_Cov_file\n\n", argv[0]);
+  fprintf(stderr, "   where options = \n");
+
+  fprintf(stderr, "         [-v]\n");
+  fprintf(stderr, "             Verbose.\n\n");
+
+
+  fprintf(stderr, "\n");
+  exit(-1);
+}
+
+
+void get_args(int argc, char *argv[])
+{
+
+  /* Require arguments (need at least one) !! */
+  if(argc == 1){
+    usage(argv);
+  }
+  /* Start at i = 1 to skip the command name. */
+  int i=1;
+
+    /* Check for a switch (leading "-"). */
+
+  while(argv[i][0] == '-') {
+
+      /* Use the next character to decide what to do. */
+
+    switch (argv[i][1]) {
+
+    case 'v': Verbose = true;
+      break;
+
+    case '?': usage(argv);
+      break;
+
+    default:  usage(argv);
+      break;
+    }
+    i++;
+	if(i==argc) usage(argv);
+  }
+
+  if(i<argc){
+      strcpy(Name_Cov_In, argv[i++]);
+  }
+  else usage(argv);
+
+  if(i < argc){
+    fprintf(stderr, "Too many parameters: %s ...\n", argv[i]);
+    usage(argv);
+  }
+
+}
+
+/*********************************************************************/
+
+/* GET PARAMETERS */
+
+void get_param()
+{
+	char Name_Param_File[256];
+	sprintf(Name_Param_File, "../param/transform_covmatrix.param");
+	FILE *File=fopen(Name_Param_File,"r");
+
+    if (File == NULL)
+    {
+		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
+		exit(-1);
+    }
+	char Temp[256];
+	int ret;
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Sqrt_Cov_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Inverse_Cov_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Log_Determ_Cov_all);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Sqrt_Cov);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Inverse_Cov);
+	fclose(File);
+}
+
+/*********************************************************************/
+
+int main(int argc, char ** argv)
+{
+	get_param();
+	get_args(argc,argv);
+
+	int TabAxis[COV_NAXIS];
+	float *Cov=fits_read_cov(Name_Cov_In, TabAxis);
+	int no=TabAxis[0], nalpha=TabAxis[1], nrout=TabAxis[2];
+	if(TabAxis[3]!=nrout)
+	{
+		cerr << "Error: " << Name_Cov_In << " is not a covariance matrix of axes (no, nalpha, nrout, nrout)" << endl;
+		exit(-1);
+	}
+	int ngrid=no*nalpha;
+	long nplane=(long) no*nalpha;
+
+	if(Verbose)
+	{
+		printf("\n\n# PARAMETERS: \n\n");
+		printf("# Input covariance matrix = %s\n", Name_Cov_In);
+		printf("# no = %d, nalpha = %d, nrout = %d\n", no, nalpha, nrout);
+		printf("# Output square root = %s\n", Name_Sqrt_Cov_all);
+		printf("# Output inverse = %s\n", Name_Inverse_Cov_all);
+		printf("# Output log-determinant = %s\n\n", Name_Log_Determ_Cov_all);
+	}
+
+	//normalization of the determinants: mean of the matrix at the middle of the grid
+	int ind_mid=no/2*nalpha+nalpha/2;
+	double mean_c0=0.;
+	for(int kl=0;kl<nrout*nrout;kl++) mean_c0+=Cov[no/2+no*(nalpha/2)+nplane*kl];
+	mean_c0/=double(nrout*nrout);
+	double log_mean_c0=log(mean_c0);
+
+	fltarray sC_all(nrout,nrout,ngrid), iC_all(nrout,nrout,ngrid), log_determC_all(ngrid);
+
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+		if(Verbose) printf("\n %u processors used for the loop \n\n",Nproc);
+	#endif
+
+	int ind;
+	long n_nonpos=0;
+	#pragma omp parallel default(shared) private(ind) reduction(+:n_nonpos) num_threads(Nproc)
+	{
+		double *A=new double[nrout*nrout];
+		double *V=new double[nrout*nrout];
+		double *l=new double[nrout];
+		double *sl=new double[nrout];
+		double *il=new double[nrout];
+
+		#pragma omp for schedule(dynamic)
+		for(ind=0;ind<ngrid;ind++)
+		{
+			int i=ind/nalpha, j=ind%nalpha;
+			for(int k=0;k<nrout;k++)
+				for(int m=0;m<nrout;m++)
+					A[k*nrout+m]=Cov[i+no*j+nplane*(k+nrout*m)];
+
+			eigen_sym(A, nrout, l, V);
+
+			double log_det=0.;
+			for(int m=0;m<nrout;m++)
+			{
+				if(l[m]<=0.) n_nonpos++;
+				sl[m]=sqrt(l[m]);
+				il[m]=1./l[m];
+				log_det+=log(l[m]);
+			}
+			log_determC_all(ind)=log_det-nrout*log_mean_c0;
+
+			for(int k=0;k<nrout;k++)
+				for(int m=k;m<nrout;m++)
+				{
+					double s=0., s_inv=0.;
+					for(int p=0;p<nrout;p++)
+					{
+						double v=V[k*nrout+p]*V[m*nrout+p];
+						s+=v*sl[p];
+						s_inv+=v*il[p];
+					}
+					sC_all(k,m,ind)=sC_all(m,k,ind)=s;
+					iC_all(k,m,ind)=iC_all(m,k,ind)=s_inv;
+				}
+		}
+		delete [] A; delete [] V; delete [] l; delete [] sl; delete [] il;
+	}
+	if(n_nonpos>0) cerr << "Warning: " << n_nonpos << " non-positive eigenvalues, the covariance matrix is not positive definite" << endl;
+
+	fits_write_fltarr(Name_Sqrt_Cov_all, sC_all);
+	fits_write_fltarr(Name_Inverse_Cov_all, iC_all);
+	fits_write_fltarr(Name_Log_Determ_Cov_all, log_determC_all);
+
+	//constant covariance matrix chosen at the middle of the grid
+	fltarray sC(nrout,nrout), iC(nrout,nrout);
+	for(int k=0;k<nrout;k++)
+		for(int m=0;m<nrout;m++)
+		{
+			sC(k,m)=sC_all(k,m,ind_mid);
+			iC(k,m)=iC_all(k,m,ind_mid);
+		}
+	fits_write_fltarr(Name_Sqrt_Cov, sC);
+	fits_write_fltarr(Name_Inverse_Cov, iC);
+
+	delete [] Cov;
+	exit(0);
+}
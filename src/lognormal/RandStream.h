@@ -0,0 +1,102 @@
+/******************************************************************************
+**
+**    UNIT
+**
+**    Version: 1.0
+**
+**    Date:  19/10/2026
+**
+**    File:  RandStream.h
+**
+*******************************************************************************
+**
+**    DESCRIPTION  Counter-based random streams
+**    -----------
+**
+**    The n-th number of the stream (seed,stream) is a hash of (seed,stream,n)
+**    (SplitMix64 finalizer), so a stream has no shared state: each thread,
+**    slab or grid point of a loop can use its own stream and the result
+**    does not depend on the number of threads or on the scheduling.
+**
+**    RandStream R(seed, stream);
+**    double u = R.uniform();     // uniform in ]0,1[
+**    double g = R.gauss();       // normal N(0,1)
+**    R.gauss(v, n);              // n normal N(0,1), always 2*((n+1)/2) numbers
+**
+******************************************************************************/
+
+#ifndef _RAND_STREAM_H_
+#define _RAND_STREAM_H_
+
+#include <stdint.h>
+#include <math.h>
+
+class RandStream {
+	uint64_t Key;
+	uint64_t Counter;
+	bool Gauss_Stored;
+	double Gauss_Next;
+
+	static inline uint64_t mix(uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+public:
+	RandStream(uint64_t seed=0, uint64_t stream=0) {init(seed,stream);}
+
+	// select the stream (seed,stream) and go back to its first number
+	inline void init(uint64_t seed, uint64_t stream)
+	{
+		Key = mix(mix(seed + 0x9e3779b97f4a7c15ULL) ^ (stream * 0xd1b54a32d192ed03ULL));
+		Counter = 0;
+		Gauss_Stored = false;
+	}
+
+	// jump directly to the n-th number of the stream
+	inline void set_counter(uint64_t n) {Counter = n; Gauss_Stored = false;}
+	inline uint64_t counter() const {return Counter;}
+
+	inline uint64_t next_int() {return mix(Key + (++Counter) * 0x9e3779b97f4a7c15ULL);}
+
+	// uniform in ]0,1[ with 53 bits
+	inline double uniform() {return ((next_int() >> 11) + 0.5) * (1.0/9007199254740992.0);}
+
+	// normal N(0,1), polar Box-Muller (the second value is kept for the next call)
+	inline double gauss()
+	{
+		if(Gauss_Stored)
+		{
+			Gauss_Stored = false;
+			return Gauss_Next;
+		}
+		double v1, v2, r, fac;
+		do {
+			v1 = 2.0*uniform()-1.0;
+			v2 = 2.0*uniform()-1.0;
+			r = v1*v1+v2*v2;
+		} while(r >= 1.0);
+		fac = sqrt(-2.0*log(r)/r);
+		Gauss_Next = v2*fac;
+		Gauss_Stored = true;
+		return v1*fac;
+	}
+
+	// fill g with n normal N(0,1), Box-Muller without rejection: the vector uses exactly
+	// 2*((n+1)/2) numbers of the stream, so set_counter can jump to the k-th vector
+	inline void gauss(double *g, int n)
+	{
+		double r, t;
+		for(int k=0;k<n;k+=2)
+		{
+			r = sqrt(-2.0*log(uniform()));
+			t = 6.283185307179586*uniform();
+			g[k] = r*cos(t);
+			if(k+1<n) g[k+1] = r*sin(t);
+		}
+	}
+};
+
+#endif
@@ -25,6 +25,13 @@
 ** 
 *******************************************************************************
 **
+**  float poidev(float xm, RandStream &R)
+**
+**  same as above but draws from the counter-based stream R and keeps no
+**  static state, so it can be called concurrently with one stream per thread.
+**
+*******************************************************************************
+**
 **  void im_poisson_noise(Ifloat &Data)
 **  
 **  add a poisson noise to an image
@@ -36,6 +43,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include "RandStream.h"
 
 #define M1 259200
 #define IA1 7141
@@ -145,6 +153,36 @@ float poidev(float xm,int *idum)
 
 /***********************************************************************/
 
+float poidev(float xm, RandStream &R)
+{
+	float sq,alxm,g,em,t,y;
+
+	if (xm < 12.0) {
+		g=exp(-xm);
+		em = -1;
+		t=1.0;
+		do {
+			em += 1.0;
+			t *= R.uniform();
+		} while (t > g);
+	} else {
+		sq=sqrt(2.0*xm);
+		alxm=log(xm);
+		g=xm*alxm-nr_gammln(xm+1.0);
+		do {
+			do {
+				y=tan(M_PI*R.uniform());
+				em=sq*y+xm;
+			} while (em < 0.0);
+			em=floor(em);
+			t=0.9*(1.0+y*y)*exp(em*alxm-nr_gammln(em+1.0)-g);
+		} while (R.uniform() > t);
+	}
+	return em;
+}
+
+/***********************************************************************/
+
 
 
 #undef M1
@@ -40,6 +40,50 @@ Version history:
          'genus' software) to know step by step what I'm doing.
          I will use FFT from library FFTW-3 (external).
          Use FFTW routines specific for real fields.
+
+  V. 0.6 (19/10/2026): P(k) and the mode variance are tabulated once
+         per distinct integer |k|^2=kx^2+ky^2+kz^2 of the grid, the
+         mode loop only reads this table. spect() finds its
+         interpolation interval in O(1) when the input k table is
+         linearly or logarithmically spaced (binary search otherwise).
+
+  V. 0.7 (19/10/2026): Compile with -DLOGNORMAL_SINGLE (cmake option
+         LOGNORMAL_SINGLE) to run the Gaussian field -> exp -> Poisson
+         chain in single precision with the fftwf_* API (needs fftw3f).
+         This halves the memory of the field and of its Fourier modes.
+         The variances and their sums are still accumulated in double.
+         Accuracy against the double build, both linked to fftw 3.3.5,
+         L=2200 Mpc/h, same seed: for N=64 (N=128) the lognormal fields
+         differ by at most 7e-8 (9e-8) relative, xi(r) of the cells for
+         34<r<550 Mpc/h by at most 1e-7 of its maximum (1.2e-5 (8e-7)
+         of its value, reached where xi(r) crosses zero), and the
+         Poisson catalogues of 1e6 galaxies are identical, i.e. far
+         below the variance of a realisation.
+
+  V. 0.8 (19/10/2026): Random numbers come from counter-based streams
+         (RandStream.h): one stream per x-slab of the k grid for the
+         modes and one per x-slab of the density grid for the Poisson
+         sampling. The sampling is parallel over slabs, each thread
+         formats its galaxies in its own buffer and the buffers are
+         written in slab order, so the catalogue only depends on the
+         seed and not on the number of threads.
+
+  V. 0.9 (19/10/2026): The survey window (footprint and radial
+         selection) is computed once per run as the list of cells with
+         a non zero nbar(d)*Delta^3 in each slab; cells outside are
+         never visited by the Poisson sampling. Option -n generates
+         several realisations reusing the window and the FFT plan.
+
+  V. 1.0 (19/10/2026): Random catalogues (-r) are drawn without any
+         grid: the number of points is Poisson with the integral of
+         nbar(d) over the mask, the distance is drawn from nbar(d)d^2,
+         the direction from the solid angle of the mask pixels, and
+         points outside the box are rejected. Cost is O(N_points).
+
+  V. 1.1 (19/10/2026): The field generation and the sampling are
+         moved to 'lognormal_obj.cc' so they can be linked by the
+         in-memory pipeline 'lognormal_cf_alpha'. The samplers can
+         return the points in memory instead of writing them.
 ********************************************************/
 
 /****************************************************
@@ -130,70 +174,11 @@ Antoine Labatie
 #include "lognormal.h"
 #include <omp.h>
 
-//For FFTW library
-#include <fftw3.h>
-
-int N=32;                  /* grid size, power of 2*/
-int N2;                 /* N/2                  */
-int N21;
-int NCB;                /* N^3                  */
-
-double *dens;              /* final density   */
-FILE *out;				/* density file			*/
-//FILE *outk;
-//FILE *outg;
-
-void gauss(double disp, double *x, double *y);
-double spect(double k);
-
-
-double Delta;        //Grid step (in Mpc/h): spacing between points in the grid
-double DCB;          //Delta^3
-
-
-//Added for log-normal field and different normalizations
-double alpha2 = 1.;    //Normalization of log-gauss field
-double saratio = 1.;   //Relative normalization of gaus and log-gaus fields
-
-
-bool Verbose = false;
-long seed;
-
 char Name_Out_Cat_Suffix[256]; /* galaxy catalogue output file name */
-char Name_Out_Cat_Prefix[256];
 char Name_Out_Cat[256];
 
 bool Catalogue_Random=false;
-
-
-//Power spectrum tab
-FILE *inpk;
-char Name_Pk_In[256];
-double *ktab, *pktab;
-long npk=0;
-
-//nbar tab
-FILE *indens;
-double *rtab, *denstab;
-long ndens=0;
-
-
-double globalvariance=0.0;
-
-
-
-//maximum number of procs used for the loops
-int Nproc_max=40;
-
-//parameters to be set in lognormal.param
-bool Use_Density=false;
-char Name_Density[256];
-bool Use_Mask=false;
-char Name_Mask[256];
-double L;       //Lenght of box side, in Mpc/h.
-double x2min, y2min, z2min;
-double nbar;
-
+int Nreal=1;               //number of realisations generated in the run
 
 /***************************************************************************/
  
@@ -215,8 +200,14 @@ static void usage(char *argv[])
   fprintf(stderr, "         [-I InitRandomVal]\n");
   fprintf(stderr, "             Value used for random value generator initialization.\n\n");
 
+  fprintf(stderr, "         [-n NRealisations]\n");
+  fprintf(stderr, "             Generate NRealisations catalogues with the same survey window and FFT plan,\n");
+  fprintf(stderr, "             catalogue r is written with '_r' added before the extension of the suffix.\n");
+  fprintf(stderr, "             Default is %d.\n\n", Nreal);
+
   fprintf(stderr, "         [-r]\n");
-  fprintf(stderr, "             Generate random catalogue (i.e. a catalogue with no fluctuations).\n\n");
+  fprintf(stderr, "             Generate random catalogue (i.e. a catalogue with no fluctuations).\n");
+  fprintf(stderr, "             Points are drawn directly from the mask and nbar(d), without the density grid.\n\n");
 	
   fprintf(stderr, "         [-v]\n");
   fprintf(stderr, "             Verbose.\n\n");
@@ -256,6 +247,11 @@ void get_args(int argc, char *argv[])
       seed = atol(argv[++i]);
       break;
 
+    case 'n':
+      Nreal = atoi(argv[++i]);
+      if(Nreal<1) usage(argv);
+      break;
+
 	case 'r': Catalogue_Random = true;
 		break;
 			
@@ -287,303 +283,16 @@ void get_args(int argc, char *argv[])
 
 }
 
-/*********************************************************************/
-
-/* GET COMMAND LINE ARGUMENTS */
-static void siminit(int argc, char *argv[])
-{
-    seed = time(NULL);
-
-    get_args(argc,argv);
-
-    srand48((long) seed);
-
-    N2=N/2; 
-    N21 = N2+1;
-    NCB=N*N*N; 
-
-    //Dimensions N^3
-    dens = (double *) malloc(NCB*sizeof(double)); assert(dens);
-
-    Delta = L/((double)N);
-    DCB=Delta*Delta*Delta;
-
-	//Read pk
-    int i;
-	int ret;
-    double temp_k, temp_pk;
-    inpk = fopen(Name_Pk_In, "r"); assert(inpk);
-
-	while ( fscanf(inpk, "%lf %lf\n", &temp_k,&temp_pk)!=EOF ) 	npk++;
-	
-	inpk = fopen(Name_Pk_In, "r"); 
-	ktab = (double *)malloc(npk*sizeof(double)); assert(ktab);
-    pktab = (double *)malloc(npk*sizeof(double)); assert(pktab);
-
-    for(i=0;i<npk;i++){
-      ret=fscanf(inpk, "%lf %lf\n", &temp_k,&temp_pk);
-      ktab[i]=temp_k; pktab[i]=temp_pk;
-    }
-   fclose(inpk);
-	
-	//Read nbar tab if external ascii file provided (i.e. if Use_Density==true in lognormal.param)
-	if(Use_Density)
-	{
-		double temp_r, temp_dens;
-		indens = fopen(Name_Density, "r"); assert(indens);
-	
-		while ( fscanf(indens, "%lf %lf\n", &temp_r,&temp_dens)!=EOF ) 	ndens++;	
-	
-		indens = fopen(Name_Density, "r"); 
-		rtab = (double *)malloc(ndens*sizeof(double)); assert(rtab);
-		denstab = (double *)malloc(ndens*sizeof(double)); assert(denstab);
-	
-		for(i=0;i<ndens;i++){
-			ret=fscanf(indens, "%lf %lf\n", &temp_r,&temp_dens);
-			rtab[i]=temp_r; denstab[i]=temp_dens;
-		}
-		fclose(indens);
-	}
-}
-
-/*********************************************************************/
-
-/* GET PARAMETERS */
-
-void get_param()
-{
-	char Name_Param_File[256];
-	sprintf(Name_Param_File, "../param/lognormal.param");	
-	FILE *File=fopen(Name_Param_File,"r");
-	
-    if (File == NULL)
-    {
-		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
-		exit(-1);
-    }
-	char Temp[256];
-	int temp_bool;
-	int ret;
-	ret=fscanf(File, "%s\t%i\n", Temp, &temp_bool);	//Use external ascii file for density as a function of distance (0 means false otherwise means true)
-	Use_Density = (temp_bool !=0);
-	ret=fscanf(File, "%s\t%s\n", Temp, Name_Density);	//Name of ascii file for density
-	ret=fscanf(File, "%s\t%i\n", Temp, &temp_bool);		//Use external fits file for mask (0 means false otherwise means true)
-	Use_Mask = (temp_bool !=0);
-	ret=fscanf(File, "%s\t%s\n\n", Temp, Name_Mask);	//Name of fits file for mask
-
-	//minimum value of x2,y2 and z2 axis. (x2,y2,z2) basis is adapted to geometry of SDSS.
-	//when providing an external (lambda,eta) mask, these coordinates will be converted to regular (x,y,z) coordinates by the transform:
-	//x = (x2-y2)/sqrt(2.0); 		y = (x2+y2)/sqrt(2.0);   			z = z2;
-	//(x,y,z) are linked to (eta,lambda) by the transform:
-	//  x = -D*sin(lambda) ;	y = D*cos(lambda)*cos(eta)  ;  z = D*cos(lambda)*sin(eta)
-	//when no mask is provided, the output coordinates stay in (x2,y2,z2) basis
-	ret=fscanf(File, "%s\t%lf\n", Temp, &x2min);		
-	ret=fscanf(File, "%s\t%lf\n", Temp, &y2min);
-	ret=fscanf(File, "%s\t%lf\n", Temp, &z2min);	
-	
-	ret=fscanf(File, "%s\t%lf\n", Temp, &L);	//size of cubic box in Mpc/h
-	ret=fscanf(File, "%s\t%lf\n\n", Temp, &nbar); //constant mean density of points in the volume (use only when Use_Density==false in lognormal.param)
-
-	ret=fscanf(File, "%s\t%s\n", Temp, Name_Out_Cat_Prefix);
-	
-	fclose(File);
-	
-}
-
-
-/*********************************************************************/
-
-
-void gen_dens()
-{
-  int ix,iy,iz, i;
-  int kxind, kyind, kzind;
-  double kmod, variance, a, b;
-  double Deltak;
-
-  int KDIM = N*N*N21;
-
-  //To avoid errors due to int division
-  double NCBf = NCB;
-	
-  fftw_complex *densk;
-  double *densr;
-  fftw_plan plan;
-
-  densr = (double *) malloc(sizeof(double) * NCB);
-  densk = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * KDIM);
-	
-  /*******************************/
-  printf("Size of a double = %ld\n", sizeof(double));
-  printf("Size of a fftw_complex = %ld\n", sizeof(fftw_complex));
-  printf("Size of 'densk' = %ld\n", sizeof(densk));
-  printf("Size of 'densr' = %ld\n", sizeof(densr));
-  /********************************/
-
-	
-  //Use FFTW's 'complex2real' routine, but now the sign in the exponent is reversed wrt
-  //our convention!!!!!
-  //plan = fftw_plan_dft_c2r_3d(N, N, N, densk, densr, FFTW_ESTIMATE);
-  plan = fftw_plan_dft_c2r_3d(N, N, N, densk, densr, FFTW_MEASURE);
-
-
-  Deltak = 2.*M_PI/L;                   //Spacing between nodes in k grid
-  fprintf(stderr, "\nDelta_k = %f\n\n",Deltak);
-
-	
-  //Generate k-modes as Gaussian distributed real and imaginary parts.
-  //Will have, as independent k-modes 0<=ix<N; 0<=iy<N; 0<=iz<N21
-	#ifdef _OPENMP
-		int Nproc=omp_get_num_procs();
-		if(Nproc>Nproc_max) Nproc=Nproc_max;
-		printf("\n %u processors used for the loop \n\n",Nproc);
-	#endif	
-	
-	#pragma omp parallel default(none)  shared(N,N2,N21,NCB,NCBf,DCB,densk,Deltak,stderr,globalvariance) \
-	private(ix,iy,iz,kxind,kyind,kzind,kmod,variance,a,b) num_threads(Nproc)
-	{
-		#pragma omp for schedule(static)
-		for(ix=0;ix<N;ix++)
-		{
-			if(ix<=N2) {kxind = ix;}   //Positive kx
-			else {kxind = ix - N;}     //Negative kx
-			for(iy=0;iy<N;iy++)
-			{
-				if(iy<=N2) {kyind = iy;}   //Positive ky
-				else {kyind = iy - N;}     //Negative ky
-				for(iz=0;iz<N21;iz++) 
-				{
-					kzind = iz;               //Only positive kz
-					kmod = Deltak*sqrt( (kxind*kxind) + (kyind*kyind) + (kzind*kzind) );
-
-					/*
-					 Not all the modes generated in densk are independent normally. 
-					 Indeed the modes (kxind,kyind,kzind) and (N-kxind,N-kyind,N-kzind) are always complex conjugates.
-					 So the part kz>=N21 can always be deduced from the part kz<N21 and the missing part of the array is added following this.
-					 But other parts are also redundant for example the modes (0,kyind,kzind) and (0,N-kyind,N-kzind).
-					 fftw does a normal inverse FFT and finally keeps the real part only so we can still generate independent modes even if 
-					 they are not (we just have to adjust the variance to have the correct amount of power for each mode).
-				 
-					 Each mode k verifies <|delta_k|^2|>=<a^2+b^2>=P(k)(dk)^3/(2*Pi)^3=P(k)/L^3
-					 Because of the further normalization by N^3 we must multiply this by N^6 to get <a^2>=<b^2>=0.5*P(k)*N^6/L^3=0.5*P(k)*NCB/DCB
-					 For the modes that we generate independently but which are not in reality independent (there is a pair which should be conjugate) 
-					 the result will result in adding 2 indepdent variables X+Y instead of having 2*X so the variance will be underestimated by a factor 2,
-					 that's why we take for them P(k)*NCB/DCB.
-					 Finally for the modes that are always real like P(0) and P(N/2) if N is even then <|delta_k|^2|>=<a^2> and the variance of a must 
-					 be also taken =P(k)*NCB/DCB
-					 */
-				
-					if(iz==0 || (N/2==N/2.0 && iz ==N/2)) 
-					{
-						variance = spect(kmod)*NCB/DCB;
-						# pragma omp critical
-							globalvariance+= variance;
-					}
-					else 
-					{
-						variance = 0.5*spect(kmod)*NCB/DCB;
-						# pragma omp critical
-							globalvariance+= 4.0*variance;
-					}
-					gauss(variance, &a, &b); 
-					densk[(N*N21*ix)+(N21*iy)+iz][0] = a;     //Real part
-					densk[(N*N21*ix)+(N21*iy)+iz][1] = b;     //Imag. part
-			
-				}
-			}
-		}
-	}
-
-  
-	//Make FFT transform
-	fftw_execute(plan);
-  
-	//Now, values of \delta(x) (unnormalized) are stored in densr, we normalize it 
-	//(same for 3 dimensions, real and imag. parts):
-	for(i=0;i<NCB;i++)
-		densr[i] = densr[i]/NCBf;
-
-  globalvariance/=(NCBf*NCBf);
-	
-  //Calculate value of \alpha2 from the global variance
-  alpha2=globalvariance;
-  
-  printf("\nGaussian field:\n");
-  printf("Theoretical global variance = %f\n", globalvariance);
-
-	
-  /*************************************************/
-
-  //Transformation to log-gaussian field, just local transform
-    //(could do it with less loops, I know...)
-  for(ix=0; ix<N; ix++){
-    for(iy=0;iy<N;iy++){
-      for(iz=0;iz<N;iz++){
-	dens[(N*N*ix) + (N*iy) + iz] = exp( (saratio*densr[(N*N*ix) + (N*iy) + iz]) - (alpha2/2.) );
-      }
-    }
-  }
-
-  fftw_destroy_plan(plan);
-  fftw_free(densk);
-  free(densr);
-  
-}
-
-
-
-/*************************************************/
-
-void gauss(double disp, double *x, double *y)    /* Recipes */
-{
-	//Create a 2D gaussian independent in x,y  => f(x,y)=1/(2*pi*sigma) e^-(x^2+y^2)/(2*sigma^2)
-    double v1,v2,r,fac;
-
-    do {
-        v1=2.0*drand48()-1; 
-        v2=2.0*drand48()-1; 
-        r=v1*v1+v2*v2;
-        }
-    while(r>=1.0);
-    fac=sqrt(-2*disp*log((double) r)/r);
-    *x=v1*fac;
-    *y=v2*fac;
-}
-  
-
-double spect(double k)
-{
-
-  //Change: assign P(0) = 0 -- Is this correct????
-  if(k==0){
-    return(0.);
-  }
-  else{
-
-    //Implement here the linear interpolation:
-    int i=0;
-	  while(k > ktab[i] && i<npk-1)  i++;
-    if(i==0 || i>=(npk-1)){
-	  printf("ktab[0]: %f, k: %f, i: %u, npk: %lu \n",ktab[0],k,i,npk);
-      fprintf(stderr, "Error: k-value outside of tabulated values!\n");
-      exit(1);
-    }
-    
-    double P;
-    P = pktab[i-1] + ( (pktab[i] - pktab[i-1])*(k-ktab[i-1])/(ktab[i] - ktab[i-1]));
-
-    return(P);
-  }
-
-}
 
 int main(int argc, char ** argv)
 {
     int i,j,k;
 	
+	seed = time(NULL);
 	get_param();
-    siminit(argc,argv);
-	strcpy(Name_Out_Cat, Name_Out_Cat_Prefix); strcat(Name_Out_Cat, Name_Out_Cat_Suffix);
+	get_args(argc,argv);
+	init_sim();
+	name_realisation(Name_Out_Cat, Name_Out_Cat_Prefix, Name_Out_Cat_Suffix, 0, Nreal);
 	
     if (Verbose)
     { 
@@ -591,6 +300,7 @@ int main(int argc, char ** argv)
 		printf("# Input P(k) File = %s\n", Name_Pk_In);
 		if(Catalogue_Random) printf("# Generate random catalogue with no fluctuations\n");
 		printf("# Write catalogue in ascii = %s\n", Name_Out_Cat);
+		if(Nreal>1) printf("# Number of realisations = %d\n", Nreal);
 		printf("# Dimension = %d\n", N);
 		printf("# Box Length = %f Mpc/h\n", L);    
 		if(Use_Density) 
@@ -601,13 +311,39 @@ int main(int argc, char ** argv)
 		printf("# (x2min,y2min,z2min) = %f\t%f\t%f\n\n", x2min,y2min,z2min);
     }
 	
+	if(Catalogue_Random) //Generate random catalogue (no fluctuations)
+	{
+		init_random_sampler();
+		for(Ireal=0;Ireal<Nreal;Ireal++)
+		{
+			name_realisation(Name_Out_Cat, Name_Out_Cat_Prefix, Name_Out_Cat_Suffix, Ireal, Nreal);
+			if(Verbose) printf("\nSample random catalogue in %s\n",Name_Out_Cat);
+			
+			FILE *outcatalogue;
+			outcatalogue = fopen(Name_Out_Cat, "w"); assert(outcatalogue);
+			long int Ngal=sample_random(outcatalogue);
+			fclose(outcatalogue);
+			
+			printf("N_galaxies= %li\n \n \n",Ngal);
+		}
+		free_random_sampler();
+		exit(0);
+	}
+	
 	fltarray dens_array(N,N,N);
-	double mean=0;
-	double sumsq=0;
-	double sigma=0;
 	
-	if(!Catalogue_Random)
+	//The survey window and the FFT plan do not depend on the realisation
+	init_window();
+	init_fft();
+	
+	for(Ireal=0;Ireal<Nreal;Ireal++)
 	{
+		double mean=0;
+		double sumsq=0;
+		double sigma=0;
+		
+		name_realisation(Name_Out_Cat, Name_Out_Cat_Prefix, Name_Out_Cat_Suffix, Ireal, Nreal);
+		
 		gen_dens();
 		
 		for(i=0;i<N;i++){
@@ -619,145 +355,28 @@ int main(int argc, char ** argv)
 				}
 			}
 		}
-	}
-	else //Generate random catalogue (no fluctuations)
-	{
-		for(i=0;i<N;i++){
-			for(j=0;j<N;j++){
-				for(k=0;k<N;k++){
-					dens_array(i,j,k)=1.0;
-				}
-			}
-		}
-	}
-	
-    if(Verbose){
-      mean = mean/NCB;
-      sigma = (sumsq/NCB) - (mean*mean); sigma=sqrt(sigma);
-      if(!Catalogue_Random)
-	  {
+		
+		if(Verbose){
+		  mean = mean/NCB;
+		  sigma = (sumsq/NCB) - (mean*mean); sigma=sqrt(sigma);
 		  printf("\nLognormal field:\n");
 		  printf("Sample Mean = %f , Sigma = %f\n ", mean, sigma);
-	  }
-    }
-	
-	
-	//Do Poisson sampling on the density field to get a galaxy catalogue with a given density
-	if(Verbose) printf("\nSample continuous and write galaxy catalogue in %s\n",Name_Out_Cat);
-	long int Ngal=0;
-	int number=-1;
-	int n=0;
-	
-	//Open Out_Catalogue_File
-	FILE *outcatalogue;
-	outcatalogue = fopen(Name_Out_Cat, "w"); assert(outcatalogue);
-
-	double shift_x,shift_y,shift_z;
-	double x2,y2,z2;
-	double x,y,z;
-	
-	double dmin,dmax,deltad;
-	int indd;
-	
-	double d,lambda,eta,dlambda,deta;
-	int indlambda,indeta;
-	fltarray Mask;
-	
-	double r2d=180/M_PI;
+		}
 		
-	fprintf(outcatalogue, "x  y  z \n");
-
-	if(Use_Density) 
-	{
-		deltad=(rtab[ndens-1]-rtab[0])/double(ndens-1.0);
-		dmin=rtab[0]-deltad/2.0;
-		dmax=rtab[ndens-1]+deltad/2.0;
-	}
-	if(Use_Mask)
-	{
-		fits_read_fltarr(Name_Mask,Mask);
-		dlambda=360.0/double(Mask.nx());
-		deta=180.0/double(Mask.ny());
-	}
-	
-
-	for(i=0;i<N;i++){
-		for(j=0;j<N;j++){
-			for(k=0;k<N;k++){
-				x2=i*Delta+x2min;  			y2=j*Delta+y2min;  				z2=k*Delta+z2min;
-				
-				if(Use_Mask)
-				{
-					x=(x2-y2)/sqrt(2.0); 		y=(x2+y2)/sqrt(2.0);   			z=z2;
-					d=sqrt(x*x+y*y+z*z);
-					if(y>0) lambda=-asin(x/d); 
-					if(y<=0) lambda=M_PI+asin(x/d);
-					eta=asin(z/(d*cos(lambda)));
-					lambda*=r2d; 				eta*=r2d;
-					
-					if(lambda>180.0) 
-						lambda-=360.0;
-					
-					indlambda=floor((lambda+180.0)/dlambda);
-					indeta=floor((eta+90.0)/deta);
-				
-					if( (Mask(indlambda,indeta)==1) && (d>=dmin) && (d<=dmax) )
-					{
-						if(Use_Density)
-						{
-							indd=floor((d-dmin)/deltad);
-							if(indd<0 || indd>=ndens) 
-								nbar=0;
-							else
-								nbar=denstab[indd];
-						}
-						n=(int) poidev(nbar*pow(Delta,3.)*dens_array(i,j,k),&number);
-						while(n>0)
-						{
-							shift_x=drand48(); 	shift_y=drand48();  shift_z=drand48();
-						
-							x2=(i+shift_x)*Delta+x2min; y2=(j+shift_y)*Delta+y2min; z2=(k+shift_z)*Delta+z2min;
-							x=(x2-y2)/sqrt(2.0); y=(x2+y2)/sqrt(2.0); z=z2;
-
 		
-							
-							fprintf(outcatalogue, "%f  %f  %f \n",x,y,z);
-							Ngal++;
-							n--;
-						}
-					}
-				}
-				else
-				{
-					d=sqrt(x2*x2+y2*y2+z2*z2);
-					if(Use_Density)
-					{
-						indd=floor((d-dmin)/deltad);
-						if(indd<0 || indd>=ndens) 
-							nbar=0;
-						else
-							nbar=denstab[indd];
-					}
-					n=(int) poidev(nbar*pow(Delta,3.)*dens_array(i,j,k),&number);
-					while(n>0)
-					{
-						shift_x=drand48(); 	shift_y=drand48();  shift_z=drand48();
-						
-						x2=(i+shift_x)*Delta+x2min; y2=(j+shift_y)*Delta+y2min; z2=(k+shift_z)*Delta+z2min;
-						
-						fprintf(outcatalogue, "%f  %f  %f \n",x2,y2,z2);
-						Ngal++;
-						n--;
-					}
-				}
-			}
-		}	
+		//Do Poisson sampling on the density field to get a galaxy catalogue with a given density
+		if(Verbose) printf("\nSample continuous and write galaxy catalogue in %s\n",Name_Out_Cat);
+		
+		//Open Out_Catalogue_File
+		FILE *outcatalogue;
+		outcatalogue = fopen(Name_Out_Cat, "w"); assert(outcatalogue);
+		long int Ngal=sample_catalogue(dens_array, outcatalogue);
+		fclose(outcatalogue);
+		
+		printf("N_galaxies= %li\n \n \n",Ngal);
 	}
 	
-	printf("N_galaxies= %i\n \n \n",Ngal);
-	fclose(outcatalogue);
-	
-	
-	free(dens);
+	free_fft();
+	free_window();
     exit(0);
 }
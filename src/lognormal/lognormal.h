@@ -9,22 +9,93 @@
 **    Author: 	J.L. Starck
 **
 **    Date: 	27/08/99
-**    
+**
 **    File:  	CF_Ana.h
 **
 ************************************************************
 **
-**  1D,2D,3D correlation function analysis 
-**  
+**  1D,2D,3D correlation function analysis
+**
 ************************************************************/
 
 
 #ifndef	_SIMLOGGAUSBOX_H_
 #define	_SIMLOGGAUSBOX_H_
 
+#include <vector>
+#include "Array.h"
+#include "RandStream.h"
+
+//For FFTW library
+#include <fftw3.h>
+
+//Precision of the Gaussian field -> exp -> Poisson chain
+#ifdef LOGNORMAL_SINGLE
+typedef float lnreal;
+typedef fftwf_complex lncomplex;
+typedef fftwf_plan lnplan;
+#define FFTW(name) fftwf_##name
+#else
+typedef double lnreal;
+typedef fftw_complex lncomplex;
+typedef fftw_plan lnplan;
+#define FFTW(name) fftw_##name
+#endif
+
+//Random streams: one per realisation, stage and slab (see RandStream.h)
+#define STREAM_MODES 1
+#define STREAM_SAMPLING 2
+#define STREAM_RANDOM_TOTAL 3
+#define STREAM_RANDOM_POINTS 4
+#define STREAM_ALPHA_DATA 5
+#define STREAM_ALPHA_RANDOM 6
+extern int Ireal;                 //current realisation
+inline uint64_t stream_id(int stage, int slab) {return (((uint64_t) Ireal)<<40) + (((uint64_t) stage)<<32) + (uint64_t) slab;}
+
 //For Poisson sampling
 float poidev(float xm,int *idum);
+float poidev(float xm, RandStream &R);
 
-#endif
 
+//Lognormal field and catalogues (lognormal_obj.cc), used by the programs
+//'lognormal' and 'lognormal_cf_alpha'
+extern int N;                  //grid size
+extern int NCB;                //N^3
+extern lnreal *dens;           //lognormal density field (allocated by init_fft)
+extern double Delta;           //grid step in Mpc/h
+extern double saratio;         //sigma_0/alpha
+extern bool Verbose;
+extern long seed;
+extern char Name_Pk_In[256];
+extern int Nproc_max;
+
+//parameters set in lognormal.param
+extern bool Use_Density;
+extern char Name_Density[256];
+extern bool Use_Mask;
+extern char Name_Mask[256];
+extern double L;
+extern double x2min, y2min, z2min;
+extern double nbar;
+extern char Name_Out_Cat_Prefix[256];
+
+void get_param();
+void init_sim();                //grid steps, P(k) and nbar(d) tables, after get_param() and the options
+void init_fft();
+void gen_dens();
+void free_fft();
+void init_window();
+void free_window();
+void init_random_sampler();
+void free_random_sampler();
 
+//Poisson sampling of dens_array (or of the window only for sample_random) with the streams of
+//realisation Ireal: galaxies are written in outcatalogue and/or appended (x,y,z) to Points
+//when these are not NULL, return the number of galaxies
+long sample_catalogue(fltarray &dens_array, FILE *outcatalogue, std::vector<float> *Points=NULL);
+long sample_random(FILE *outcatalogue, std::vector<float> *Points=NULL);
+
+//Name=Prefix+Suffix, with '_real' added before the extension of Suffix when nreal>1
+void name_realisation(char *Name, const char *Prefix, const char *Suffix, int real, int nreal);
+
+#endif
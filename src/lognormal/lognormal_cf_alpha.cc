@@ -0,0 +1,418 @@
+/*******************************************************
+Program: 'lognormal_cf_alpha.cc'
+
+In-memory version of the chain used in idl/script.pro for each
+lognormal simulation:
+
+  lognormal -> rmk_catalogue -> lognormal -r -> rmk_catalogue -> cf_alpha
+
+The lognormal field, the galaxy and random catalogues, their alpha
+belonging and the alpha-dependent pair counts are computed in the
+same process, the points are passed in memory and only the final
+pair counts are written (same FITS file as 'cf_alpha', in the
+output folder of cf_alpha.param). The intermediate catalogues can be
+written for debugging with -c.
+
+The parameters are read in lognormal.param, rmk_catalogue.param and
+cf_alpha.param (the alpha tables of the last two must agree). The
+survey window, the selection table and the FFT plan are computed once
+and reused by the realisations of option -n.
+
+Version history:
+
+  V. 0.1 (19/10/2026): Initial version.
+********************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <ctime>
+#include "Array.h"
+#include "IM_IO.h"
+#include "DefPoint.h"
+#include "lognormal.h"
+#include "rmk_catalogue.h"
+#include "../cf_alpha/cf_alpha.h"
+#include <omp.h>
+
+char Name_Out_Suffix[256];      /* pair counts output file suffix */
+char Name_Out_Prefix[256];      /* pair counts output folder (cf_alpha.param) */
+char Name_Out[256];
+
+int Nreal=1;                    //number of realisations generated in the run
+bool Write_Catalogues=false;    //write the intermediate catalogues (debug)
+
+float DistMin=-1;
+float DistMax=-1;
+float Step=1.;
+
+
+/***************************************************************************/
+
+static void usage(char *argv[])
+{
+
+  fprintf(stderr, "Usage: %s options in_Pk_file out_PairCounts_file_suffix\n\n", argv[0]);
+  fprintf(stderr, "   where options = \n");
+
+  fprintf(stderr, "        [-d Dimension]\n");
+  fprintf(stderr, "            Cube size dimension in the simulation.\n");
+  fprintf(stderr, "            Default is %2d.\n\n", N);
+
+  fprintf(stderr, "         [-s SigAlpRatio]\n");
+  fprintf(stderr, "             Ratio of normalizations of gaussian to log-gaussian fields: sigma_0/alpha.\n");
+  fprintf(stderr, "             Default is %.1f\n\n", saratio);
+
+  fprintf(stderr, "         [-I InitRandomVal]\n");
+  fprintf(stderr, "             Value used for random value generator initialization.\n\n");
+
+  fprintf(stderr, "         [-n NRealisations]\n");
+  fprintf(stderr, "             Number of realisations, realisation r is written with '_r' added before\n");
+  fprintf(stderr, "             the extension of the suffix. Default is %d.\n\n", Nreal);
+
+  fprintf(stderr, "         [-m SepMin]\n");
+  fprintf(stderr, "             Pair separations min.\n");
+  fprintf(stderr, "             Must be set. \n\n");
+
+  fprintf(stderr, "         [-M SepMax]\n");
+  fprintf(stderr, "             Pair separations max.\n");
+  fprintf(stderr, "             Must be set. \n\n");
+
+  fprintf(stderr, "         [-S BinStep]\n");
+  fprintf(stderr, "             Pair separations bin size.\n");
+  fprintf(stderr, "             Default is %f. \n\n", Step);
+
+  fprintf(stderr, "         [-c]\n");
+  fprintf(stderr, "             Also write the galaxy and random catalogues and their alpha belonging\n");
+  fprintf(stderr, "             (input files of cf_alpha) in the output folder of lognormal.param.\n\n");
+
+  fprintf(stderr, "         [-v]\n");
+  fprintf(stderr, "             Verbose.\n\n");
+
+
+  fprintf(stderr, "\n");
+  exit(-1);
+}
+
+
+void get_args(int argc, char *argv[])
+{
+  bool DMin=false, DMax=false;
+
+  /* Require arguments (need at least one) !! */
+  if(argc == 1){
+    usage(argv);
+  }
+  /* Start at i = 1 to skip the command name. */
+  int i=1;
+
+    /* Check for a switch (leading "-"). */
+
+  while(argv[i][0] == '-') {
+
+      /* Use the next character to decide what to do. */
+
+    switch (argv[i][1]) {
+
+    case 'd': N = atoi(argv[++i]);
+      break;
+
+    case 's': saratio = atof(argv[++i]);
+      break;
+
+    case 'I':
+      seed = atol(argv[++i]);
+      break;
+
+    case 'n':
+      Nreal = atoi(argv[++i]);
+      if(Nreal<1) usage(argv);
+      break;
+
+    case 'm': DistMin = atof(argv[++i]); DMin=true;
+      break;
+
+    case 'M': DistMax = atof(argv[++i]); DMax=true;
+      break;
+
+    case 'S': Step = atof(argv[++i]);
+      break;
+
+    case 'c': Write_Catalogues = true;
+      break;
+
+    case 'v': Verbose = true;
+      break;
+
+    case '?': usage(argv);
+      break;
+
+    default:  usage(argv);
+      break;
+    }
+    i++;
+	if(i==argc) usage(argv);
+  }
+
+  if(i<(argc)-1){
+      strcpy(Name_Pk_In, argv[i++]);
+      strcpy(Name_Out_Suffix, argv[i++]);
+  }
+  else usage(argv);
+
+  if(i < argc){
+    fprintf(stderr, "Too many parameters: %s ...\n", argv[i]);
+    usage(argv);
+  }
+
+  if(!DMin || !DMax)
+  {
+    fprintf(stderr, "Error: -m and -M option must be set ...\n");
+    exit(-1);
+  }
+}
+
+/*********************************************************************/
+
+/* GET PARAMETERS OF cf_alpha.param */
+
+void get_param_cf_alpha()
+{
+	char Name_Param_File[256];
+	sprintf(Name_Param_File, "../param/cf_alpha.param");
+	FILE *File=fopen(Name_Param_File,"r");
+
+    if (File == NULL)
+    {
+		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
+		exit(-1);
+    }
+	char Temp[256];
+	double AlphaMin, AlphaMax, temp_double;
+	int ret;
+
+	ret=fscanf(File, "%s\t%lf\n", Temp, &AlphaMin);			//AlphaMin
+	ret=fscanf(File, "%s\t%lf\n", Temp, &AlphaMax);			//AlphaMax
+	ret=fscanf(File, "%s\t%lf\n\n", Temp, &temp_double);	//nalpha
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Out_Prefix);	//Name_Out prefix
+	fclose(File);
+
+	if(round(temp_double)!=nalpha || fabs(AlphaMin-alpha_min)>1e-6 || fabs(AlphaMax-alpha_max)>1e-6)
+	{
+		fprintf(stderr, "Error: the alpha tables of cf_alpha.param and rmk_catalogue.param are different!\n");
+		exit(-1);
+	}
+}
+
+/*********************************************************************/
+
+//Alpha belonging of the points (x,y,z) of Points: each point is repeated for each of its
+//alpha intervals in Cat, with the interval (in alpha indices) in CatAlpha. The u of point i
+//is the number i of the stream of 'stage', so the result does not depend on the threads.
+long make_alpha_catalogue(vector<float> &Points, int stage, ArrayPoint &Cat, ArrayPoint &CatAlpha)
+{
+	long n=Points.size()/3;
+	long i, nout=0;
+	int *start=(int *) malloc((n+1)*sizeof(int)); assert(start);
+
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+	#endif
+
+	//number of intervals of each point, then position in the output
+	#pragma omp parallel default(shared) private(i) num_threads(Nproc)
+	{
+		RandStream R(seed, stream_id(stage,0));
+		int *l=(int *) malloc((nalpha+2)*sizeof(int));
+		double d;
+
+		#pragma omp for schedule(static)
+		for(i=0;i<n;i++){
+			d=sqrt((double) Points[3*i]*Points[3*i]+(double) Points[3*i+1]*Points[3*i+1]+(double) Points[3*i+2]*Points[3*i+2]);
+			R.set_counter(i);
+			start[i+1]=alpha_transitions(d, R.uniform(), l)/2;
+		}
+		free(l);
+	}
+	start[0]=0;
+	for(i=0;i<n;i++) start[i+1]+=start[i];
+	nout=start[n];
+
+	Cat.alloc(3,nout); Cat.TCoord=TCOORD_XYZ;
+	CatAlpha.alloc(2,nout); CatAlpha.TCoord=TCOORD_XYZ;
+
+	#pragma omp parallel default(shared) private(i) num_threads(Nproc)
+	{
+		RandStream R(seed, stream_id(stage,0));
+		int *l=(int *) malloc((nalpha+2)*sizeof(int));
+		int nl, j, k;
+		double d;
+
+		#pragma omp for schedule(static)
+		for(i=0;i<n;i++){
+			if(start[i+1]==start[i]) continue;
+			d=sqrt((double) Points[3*i]*Points[3*i]+(double) Points[3*i+1]*Points[3*i+1]+(double) Points[3*i+2]*Points[3*i+2]);
+			R.set_counter(i);
+			nl=alpha_transitions(d, R.uniform(), l);
+			for(j=0,k=start[i];j<nl;j+=2,k++)
+			{
+				Cat(k).x()=Points[3*i]; Cat(k).y()=Points[3*i+1]; Cat(k).z()=Points[3*i+2];
+				CatAlpha(k).x()=l[j]; CatAlpha(k).y()=l[j+1];
+			}
+		}
+		free(l);
+	}
+
+	free(start);
+	return nout;
+}
+
+//Write a catalogue and its alpha belonging as the files of 'rmk_catalogue'
+void write_alpha_catalogue(const char *Suffix, const char *Type, ArrayPoint &Cat, ArrayPoint &CatAlpha)
+{
+	char Base[256], Name[256];
+	double d_alpha=(alpha_max-alpha_min)/double(nalpha-1.0);
+	const char *ext=strrchr(Suffix,'.');
+	int len = (ext==NULL) ? strlen(Suffix) : (int) (ext-Suffix);
+	strcpy(Base, Name_Out_Cat_Prefix); strncat(Base, Suffix, len);
+
+	sprintf(Name, "%s%s.dat", Base, Type);
+	FILE *out=fopen(Name, "w"); assert(out);
+	sprintf(Name, "%s%s_alpha.dat", Base, Type);
+	FILE *out_alpha=fopen(Name, "w"); assert(out_alpha);
+	fprintf(out, "%d 3 1\n0 0 0\n0 0 0\n0 0 0\n", Cat.np());
+	fprintf(out_alpha, "%d 2 1\n0 0 0\n0 0 0\n", Cat.np());
+	for(int i=0;i<Cat.np();i++)
+	{
+		fprintf(out, "%f  %f  %f\n", Cat(i).x(), Cat(i).y(), Cat(i).z());
+		fprintf(out_alpha, "%f  %f\n", alpha_min+d_alpha*CatAlpha(i).x(), alpha_min+d_alpha*CatAlpha(i).y());
+	}
+	fclose(out);
+	fclose(out_alpha);
+}
+
+/*********************************************************************/
+
+int main(int argc, char ** argv)
+{
+	long int times=time(NULL);
+	int i,j,k,d;
+    char Cmd[512];
+    Cmd[0] = '\0';
+    for (k =0; k < argc; k++) {strcat(Cmd, " "); strcat(Cmd, argv[k]);}
+
+	seed = time(NULL);
+	get_param();
+	get_param_selection();
+	get_param_cf_alpha();
+	get_args(argc,argv);
+	init_sim();
+
+    if (Verbose)
+    {
+		printf("\n\n# PARAMETERS: \n\n");
+		printf("# Input P(k) File = %s\n", Name_Pk_In);
+		printf("# Dimension = %d\n", N);
+		printf("# Box Length = %f Mpc/h\n", L);
+		if(Use_Density)
+			printf("# Use nbar provided in %s\n",Name_Density);
+		else
+			printf("# nbar = %f (Mpc/h)^{-1}\n", nbar);
+		if(Use_Mask) printf("# Use mask provided in %s\n",Name_Mask);
+		printf("# Selection = %s\n", Name_Selection);
+		printf("# alpha = %f .. %f, nalpha = %d\n", alpha_min, alpha_max, nalpha);
+		printf("# SeparationMin = %f SeparationMax = %f SeparationStep = %f\n", DistMin, DistMax, Step);
+		if(Nreal>1) printf("# Number of realisations = %d\n", Nreal);
+		if(Write_Catalogues) printf("# Write catalogues in %s\n", Name_Out_Cat_Prefix);
+		printf("\n");
+    }
+
+	//Everything that does not depend on the realisation
+	init_selection();
+	init_window();
+	init_fft();
+	init_random_sampler();
+
+	float AlphaStep=(alpha_max-alpha_min)/double(nalpha-1.0);
+	CorrFunAna CFA(DistMin, DistMax, Step);
+	int nbins=CFA.np();
+
+	fltarray dens_array(N,N,N);
+
+	for(Ireal=0;Ireal<Nreal;Ireal++)
+	{
+		name_realisation(Name_Out, Name_Out_Prefix, Name_Out_Suffix, Ireal, Nreal);
+
+		//Lognormal field
+		gen_dens();
+		for(i=0;i<N;i++)
+			for(j=0;j<N;j++)
+				for(k=0;k<N;k++)
+					dens_array(i,j,k)=dens[N*N*i+N*j+k];
+
+		//Galaxy and random catalogues, kept in memory
+		vector<float> Points;
+		long Ngal=sample_catalogue(dens_array, NULL, &Points);
+		ArrayPoint TabData, TabDataAlpha;
+		make_alpha_catalogue(Points, STREAM_ALPHA_DATA, TabData, TabDataAlpha);
+		vector<float>().swap(Points);
+
+		long NRnd=sample_random(NULL, &Points);
+		ArrayPoint TabRnd, TabRndAlpha;
+		make_alpha_catalogue(Points, STREAM_ALPHA_RANDOM, TabRnd, TabRndAlpha);
+		vector<float>().swap(Points);
+
+		if(Verbose)
+		{
+			printf("Realisation %d: %ld galaxies, %ld randoms\n", Ireal, Ngal, NRnd);
+			printf("Catalogues with alpha belonging: %d galaxies, %d randoms\n", TabData.np(), TabRnd.np());
+		}
+		if(Write_Catalogues)
+		{
+			char Suffix[256];
+			name_realisation(Suffix, "", Name_Out_Suffix, Ireal, Nreal);
+			write_alpha_catalogue(Suffix, "", TabData, TabDataAlpha);
+			write_alpha_catalogue(Suffix, "_random", TabRnd, TabRndAlpha);
+		}
+
+		//Unit weights
+		Point P(1); P.axis(0)=1.0;
+		ArrayPoint TabDataWeight(1,TabData.np());
+		for(k=0;k<TabData.np();k++) TabDataWeight(k)=P;
+		ArrayPoint TabRndWeight(1,TabRnd.np());
+		for(k=0;k<TabRnd.np();k++) TabRndWeight(k)=P;
+
+		//Pair counts, as in cf_alpha
+		fltarray Result(nbins, nalpha, 1+3);
+		for (d=0; d < nbins; d++)
+			for (i=0; i < nalpha; i++)
+				Result(d,i,0) = CFA.coord(d)/(alpha_min+i*AlphaStep);
+
+		fltarray CF_DataData(nbins,nalpha), CF_DataRnd(nbins,nalpha), CF_RndRnd(nbins,nalpha);
+		CFA.cf_find_pairs(TabData,TabDataWeight,TabDataAlpha,CF_DataData);
+		CFA.cf_find_pairs(TabRnd,TabRndWeight,TabRndAlpha,CF_RndRnd);
+		CFA.cf_find_pairs(TabData,TabRnd,TabDataWeight,TabRndWeight,TabDataAlpha,TabRndAlpha,CF_DataRnd);
+
+		make_histo(CF_DataData, CF_RndRnd, CF_DataRnd, Result);
+		normalize_histo(TabDataWeight,TabRndWeight,TabDataAlpha,TabRndAlpha,Result);
+
+		fitsstruct Header;
+		Header.hd_fltarray(Result, Cmd);
+		fits_write_fltarr(Name_Out, Result, &Header);
+		if(Verbose) printf("Pair counts written in %s\n\n", Name_Out);
+	}
+
+	free_random_sampler();
+	free_fft();
+	free_window();
+
+	if(Verbose)
+	{
+		long int timee=time(NULL);
+		printf("Time in sec : %ld\n", timee-times);
+	}
+    exit(0);
+}
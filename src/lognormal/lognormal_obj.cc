@@ -0,0 +1,863 @@
+/*******************************************************
+File: 'lognormal_obj.cc'
+
+Lognormal field generation and Poisson sampling of the
+catalogues, shared by the programs 'lognormal' and
+'lognormal_cf_alpha'. See 'lognormal.cc' for the description
+of the method and the version history.
+********************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <ctime>
+#include "Array.h"
+#include "IM_IO.h"
+#include "lognormal.h"
+#include <omp.h>
+
+int N=32;                  /* grid size, power of 2*/
+int N2;                 /* N/2                  */
+int N21;
+int NCB;                /* N^3                  */
+
+lnreal *dens;              /* final density   */
+FILE *out;				/* density file			*/
+//FILE *outk;
+//FILE *outg;
+
+void gauss(double disp, RandStream &R, double *x, double *y);
+
+int Ireal=0;               //current realisation
+
+//FFT arrays and plan, created once and used for every realisation
+lncomplex *densk;
+lnreal *densr;
+lnplan plan;
+double *var_shell;
+
+//Survey window, computed once: for each slab i, the cells j*N+k with a non zero
+//expected number of points are win_cell[win_start[i]..win_start[i+1]-1] and
+//win_weight is this number for a unit density, i.e. nbar(d)*Delta^3
+long *win_start;
+int *win_cell;
+float *win_weight;
+
+//Random catalogue sampler (-r): cumulative distributions of the radial bins
+//(nbar*volume) and of the mask pixels (solid angle), no density grid
+#define RANDOM_CHUNK 65536     //points drawn with the same random stream
+int rand_nbin;
+double *rand_dlo, *rand_dhi, *rand_bin_cdf;
+long rand_npix;
+int *rand_pix;
+double *rand_pix_cdf;
+int rand_neta;                 //number of eta pixels of the mask, pixel (i,j) is stored as i*rand_neta+j
+double rand_dlambda, rand_deta;
+double rand_mean;              //expected number of points before the cut by the box
+void init_spect();
+double spect(double k);
+
+
+double Delta;        //Grid step (in Mpc/h): spacing between points in the grid
+double DCB;          //Delta^3
+
+
+//Added for log-normal field and different normalizations
+double alpha2 = 1.;    //Normalization of log-gauss field
+double saratio = 1.;   //Relative normalization of gaus and log-gaus fields
+
+
+bool Verbose = false;
+long seed;
+
+char Name_Out_Cat_Prefix[256];
+
+
+//Power spectrum tab
+FILE *inpk;
+char Name_Pk_In[256];
+double *ktab, *pktab;
+long npk=0;
+int ktab_spacing=0;    //0: irregular k table, 1: linear spacing, 2: logarithmic spacing
+double ktab_step;      //step in k (linear) or in ln(k) (logarithmic)
+
+//nbar tab
+FILE *indens;
+double *rtab, *denstab;
+long ndens=0;
+
+
+double globalvariance=0.0;
+
+
+
+//maximum number of procs used for the loops
+int Nproc_max=40;
+
+//parameters to be set in lognormal.param
+bool Use_Density=false;
+char Name_Density[256];
+bool Use_Mask=false;
+char Name_Mask[256];
+double L;       //Lenght of box side, in Mpc/h.
+double x2min, y2min, z2min;
+double nbar;
+
+/*********************************************************************/
+
+/* GRID STEPS, P(k) AND nbar(d) TABLES */
+void init_sim()
+{
+    N2=N/2; 
+    N21 = N2+1;
+    NCB=N*N*N; 
+
+    Delta = L/((double)N);
+    DCB=Delta*Delta*Delta;
+
+	//Read pk
+    int i;
+	int ret;
+    double temp_k, temp_pk;
+    inpk = fopen(Name_Pk_In, "r"); assert(inpk);
+
+	while ( fscanf(inpk, "%lf %lf\n", &temp_k,&temp_pk)!=EOF ) 	npk++;
+	
+	inpk = fopen(Name_Pk_In, "r"); 
+	ktab = (double *)malloc(npk*sizeof(double)); assert(ktab);
+    pktab = (double *)malloc(npk*sizeof(double)); assert(pktab);
+
+    for(i=0;i<npk;i++){
+      ret=fscanf(inpk, "%lf %lf\n", &temp_k,&temp_pk);
+      ktab[i]=temp_k; pktab[i]=temp_pk;
+    }
+   fclose(inpk);
+   init_spect();
+	
+	//Read nbar tab if external ascii file provided (i.e. if Use_Density==true in lognormal.param)
+	if(Use_Density)
+	{
+		double temp_r, temp_dens;
+		indens = fopen(Name_Density, "r"); assert(indens);
+	
+		while ( fscanf(indens, "%lf %lf\n", &temp_r,&temp_dens)!=EOF ) 	ndens++;	
+	
+		indens = fopen(Name_Density, "r"); 
+		rtab = (double *)malloc(ndens*sizeof(double)); assert(rtab);
+		denstab = (double *)malloc(ndens*sizeof(double)); assert(denstab);
+	
+		for(i=0;i<ndens;i++){
+			ret=fscanf(indens, "%lf %lf\n", &temp_r,&temp_dens);
+			rtab[i]=temp_r; denstab[i]=temp_dens;
+		}
+		fclose(indens);
+	}
+}
+
+/*********************************************************************/
+
+/* GET PARAMETERS */
+
+void get_param()
+{
+	char Name_Param_File[256];
+	sprintf(Name_Param_File, "../param/lognormal.param");	
+	FILE *File=fopen(Name_Param_File,"r");
+	
+    if (File == NULL)
+    {
+		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
+		exit(-1);
+    }
+	char Temp[256];
+	int temp_bool;
+	int ret;
+	ret=fscanf(File, "%s\t%i\n", Temp, &temp_bool);	//Use external ascii file for density as a function of distance (0 means false otherwise means true)
+	Use_Density = (temp_bool !=0);
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Density);	//Name of ascii file for density
+	ret=fscanf(File, "%s\t%i\n", Temp, &temp_bool);		//Use external fits file for mask (0 means false otherwise means true)
+	Use_Mask = (temp_bool !=0);
+	ret=fscanf(File, "%s\t%s\n\n", Temp, Name_Mask);	//Name of fits file for mask
+
+	//minimum value of x2,y2 and z2 axis. (x2,y2,z2) basis is adapted to geometry of SDSS.
+	//when providing an external (lambda,eta) mask, these coordinates will be converted to regular (x,y,z) coordinates by the transform:
+	//x = (x2-y2)/sqrt(2.0); 		y = (x2+y2)/sqrt(2.0);   			z = z2;
+	//(x,y,z) are linked to (eta,lambda) by the transform:
+	//  x = -D*sin(lambda) ;	y = D*cos(lambda)*cos(eta)  ;  z = D*cos(lambda)*sin(eta)
+	//when no mask is provided, the output coordinates stay in (x2,y2,z2) basis
+	ret=fscanf(File, "%s\t%lf\n", Temp, &x2min);		
+	ret=fscanf(File, "%s\t%lf\n", Temp, &y2min);
+	ret=fscanf(File, "%s\t%lf\n", Temp, &z2min);	
+	
+	ret=fscanf(File, "%s\t%lf\n", Temp, &L);	//size of cubic box in Mpc/h
+	ret=fscanf(File, "%s\t%lf\n\n", Temp, &nbar); //constant mean density of points in the volume (use only when Use_Density==false in lognormal.param)
+
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Out_Cat_Prefix);
+	
+	fclose(File);
+	
+}
+
+
+/*********************************************************************/
+
+
+void init_fft()
+{
+  int k2;
+  double Deltak;
+
+  int KDIM = N*N*N21;
+
+  //Dimensions N^3
+  dens = (lnreal *) malloc(NCB*sizeof(lnreal)); assert(dens);
+  densr = (lnreal *) malloc(sizeof(lnreal) * NCB);
+  densk = (lncomplex *) FFTW(malloc)(sizeof(lncomplex) * KDIM);
+	
+  /*******************************/
+  printf("Size of a real = %ld\n", sizeof(lnreal));
+  printf("Size of a complex = %ld\n", sizeof(lncomplex));
+  printf("Size of 'densk' = %ld\n", sizeof(densk));
+  printf("Size of 'densr' = %ld\n", sizeof(densr));
+  /********************************/
+
+	
+  //Use FFTW's 'complex2real' routine, but now the sign in the exponent is reversed wrt
+  //our convention!!!!!
+  //plan = fftw_plan_dft_c2r_3d(N, N, N, densk, densr, FFTW_ESTIMATE);
+  plan = FFTW(plan_dft_c2r_3d)(N, N, N, densk, densr, FFTW_MEASURE);
+
+
+  Deltak = 2.*M_PI/L;                   //Spacing between nodes in k grid
+  fprintf(stderr, "\nDelta_k = %f\n\n",Deltak);
+
+  //|k|^2 only takes the integer values kxind^2+kyind^2+kzind^2 <= 3*N2^2 on the grid,
+  //so P(k)*NCB/DCB is computed once for each of them
+  int NK2 = 3*N2*N2+1;
+  var_shell = (double *) malloc(NK2*sizeof(double)); assert(var_shell);
+  for(k2=0;k2<NK2;k2++)
+	var_shell[k2] = spect(Deltak*sqrt((double) k2))*NCB/DCB;
+}
+
+void free_fft()
+{
+  FFTW(destroy_plan)(plan);
+  FFTW(free)(densk);
+  free(densr);
+  free(var_shell);
+  free(dens);
+}
+
+void gen_dens()
+{
+  int ix,iy,iz, i;
+  int kxind, kyind, kzind;
+  int k2;
+  double variance, a, b;
+
+  //To avoid errors due to int division
+  double NCBf = NCB;
+
+  globalvariance=0.0;
+	
+  //Generate k-modes as Gaussian distributed real and imaginary parts.
+  //Will have, as independent k-modes 0<=ix<N; 0<=iy<N; 0<=iz<N21
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+		printf("\n %u processors used for the loop \n\n",Nproc);
+	#endif	
+	
+	#pragma omp parallel default(none)  shared(N,N2,N21,densk,var_shell,globalvariance,seed) \
+	private(ix,iy,iz,kxind,kyind,kzind,k2,variance,a,b) num_threads(Nproc)
+	{
+		RandStream R;
+		#pragma omp for schedule(static) reduction(+:globalvariance)
+		for(ix=0;ix<N;ix++)
+		{
+			R.init(seed, stream_id(STREAM_MODES,ix));
+			if(ix<=N2) {kxind = ix;}   //Positive kx
+			else {kxind = ix - N;}     //Negative kx
+			for(iy=0;iy<N;iy++)
+			{
+				if(iy<=N2) {kyind = iy;}   //Positive ky
+				else {kyind = iy - N;}     //Negative ky
+				for(iz=0;iz<N21;iz++) 
+				{
+					kzind = iz;               //Only positive kz
+					k2 = (kxind*kxind) + (kyind*kyind) + (kzind*kzind);
+
+					/*
+					 Not all the modes generated in densk are independent normally. 
+					 Indeed the modes (kxind,kyind,kzind) and (N-kxind,N-kyind,N-kzind) are always complex conjugates.
+					 So the part kz>=N21 can always be deduced from the part kz<N21 and the missing part of the array is added following this.
+					 But other parts are also redundant for example the modes (0,kyind,kzind) and (0,N-kyind,N-kzind).
+					 fftw does a normal inverse FFT and finally keeps the real part only so we can still generate independent modes even if 
+					 they are not (we just have to adjust the variance to have the correct amount of power for each mode).
+				 
+					 Each mode k verifies <|delta_k|^2|>=<a^2+b^2>=P(k)(dk)^3/(2*Pi)^3=P(k)/L^3
+					 Because of the further normalization by N^3 we must multiply this by N^6 to get <a^2>=<b^2>=0.5*P(k)*N^6/L^3=0.5*P(k)*NCB/DCB
+					 For the modes that we generate independently but which are not in reality independent (there is a pair which should be conjugate) 
+					 the result will result in adding 2 indepdent variables X+Y instead of having 2*X so the variance will be underestimated by a factor 2,
+					 that's why we take for them P(k)*NCB/DCB.
+					 Finally for the modes that are always real like P(0) and P(N/2) if N is even then <|delta_k|^2|>=<a^2> and the variance of a must 
+					 be also taken =P(k)*NCB/DCB
+					 */
+				
+					if(iz==0 || (N/2==N/2.0 && iz ==N/2)) 
+					{
+						variance = var_shell[k2];
+						globalvariance+= variance;
+					}
+					else 
+					{
+						variance = 0.5*var_shell[k2];
+						globalvariance+= 4.0*variance;
+					}
+					gauss(variance, R, &a, &b); 
+					densk[(N*N21*ix)+(N21*iy)+iz][0] = a;     //Real part
+					densk[(N*N21*ix)+(N21*iy)+iz][1] = b;     //Imag. part
+			
+				}
+			}
+		}
+	}
+
+  
+	//Make FFT transform
+	FFTW(execute)(plan);
+  
+	//Now, values of \delta(x) (unnormalized) are stored in densr, we normalize it 
+	//(same for 3 dimensions, real and imag. parts):
+	for(i=0;i<NCB;i++)
+		densr[i] = densr[i]/NCBf;
+
+  globalvariance/=(NCBf*NCBf);
+	
+  //Calculate value of \alpha2 from the global variance
+  alpha2=globalvariance;
+  
+  printf("\nGaussian field:\n");
+  printf("Theoretical global variance = %f\n", globalvariance);
+
+	
+  /*************************************************/
+
+  //Transformation to log-gaussian field, just local transform
+    //(could do it with less loops, I know...)
+  for(ix=0; ix<N; ix++){
+    for(iy=0;iy<N;iy++){
+      for(iz=0;iz<N;iz++){
+	dens[(N*N*ix) + (N*iy) + iz] = exp( (saratio*densr[(N*N*ix) + (N*iy) + iz]) - (alpha2/2.) );
+      }
+    }
+  }
+  
+}
+
+
+
+/*************************************************/
+
+void gauss(double disp, RandStream &R, double *x, double *y)    /* Recipes */
+{
+	//Create a 2D gaussian independent in x,y  => f(x,y)=1/(2*pi*sigma) e^-(x^2+y^2)/(2*sigma^2)
+    double v1,v2,r,fac;
+
+    do {
+        v1=2.0*R.uniform()-1; 
+        v2=2.0*R.uniform()-1; 
+        r=v1*v1+v2*v2;
+        }
+    while(r>=1.0);
+    fac=sqrt(-2*disp*log((double) r)/r);
+    *x=v1*fac;
+    *y=v2*fac;
+}
+  
+
+void init_spect()
+{
+  //Check if the k table is regularly spaced in k or in ln(k), in which case
+  //spect() can compute directly the index of the interpolation interval.
+  //Each tabulated k must lie within half a step of its regular position.
+  int i;
+  ktab_spacing=0;
+  if(npk<3) return;
+
+  ktab_step=(ktab[npk-1]-ktab[0])/double(npk-1);
+  for(i=0;i<npk;i++)
+	if(fabs(ktab[i]-ktab[0]-i*ktab_step) > 0.5*ktab_step) break;
+  if(i==npk && ktab_step>0)
+  {
+	ktab_spacing=1;
+	return;
+  }
+
+  if(ktab[0]<=0) return;
+  ktab_step=log(ktab[npk-1]/ktab[0])/double(npk-1);
+  for(i=0;i<npk;i++)
+	if(ktab[i]<=0 || fabs(log(ktab[i]/ktab[0])-i*ktab_step) > 0.5*ktab_step) break;
+  if(i==npk && ktab_step>0) ktab_spacing=2;
+}
+
+double spect(double k)
+{
+
+  //Change: assign P(0) = 0 -- Is this correct????
+  if(k==0){
+    return(0.);
+  }
+  else{
+
+    //Implement here the linear interpolation:
+    //i is the first index with ktab[i]>=k (or npk-1 if there is none)
+    int i, imin, imax;
+    if(ktab_spacing==1)
+	  i=(int) ceil((k-ktab[0])/ktab_step);
+    else if(ktab_spacing==2)
+	  i=(int) ceil(log(k/ktab[0])/ktab_step);
+    else
+    {
+	  imin=0; imax=npk-1;
+	  while(imin<imax)
+	  {
+		i=(imin+imax)/2;
+		if(ktab[i]<k) imin=i+1;
+		else imax=i;
+	  }
+	  i=imin;
+    }
+    if(i<0) i=0;
+    if(i>npk-1) i=npk-1;
+    while(i>0 && ktab[i-1]>=k) i--;
+    while(i<npk-1 && ktab[i]<k) i++;
+
+    if(i==0 || i>=(npk-1)){
+	  printf("ktab[0]: %f, k: %f, i: %u, npk: %lu \n",ktab[0],k,i,npk);
+      fprintf(stderr, "Error: k-value outside of tabulated values!\n");
+      exit(1);
+    }
+    
+    double P;
+    P = pktab[i-1] + ( (pktab[i] - pktab[i-1])*(k-ktab[i-1])/(ktab[i] - ktab[i-1]));
+
+    return(P);
+  }
+
+}
+
+void init_window()
+{
+	//Expected number of points in each cell for a unit density field, i.e. nbar(d)*Delta^3
+	//inside the footprint and in the radial range, 0 otherwise. Only non zero cells are kept.
+	int i,j,k;
+	double x2,y2,z2;
+	double x,y,z;
+	
+	double dmin,dmax,deltad;
+	int indd;
+	double nbar_cell;
+	bool inside;
+	
+	double d,lambda,eta,dlambda,deta;
+	int indlambda,indeta;
+	fltarray Mask;
+	
+	double r2d=180/M_PI;
+
+	dmin=0; dmax=HUGE_VAL;
+	if(Use_Density) 
+	{
+		deltad=(rtab[ndens-1]-rtab[0])/double(ndens-1.0);
+		dmin=rtab[0]-deltad/2.0;
+		dmax=rtab[ndens-1]+deltad/2.0;
+	}
+	if(Use_Mask)
+	{
+		fits_read_fltarr(Name_Mask,Mask);
+		dlambda=360.0/double(Mask.nx());
+		deta=180.0/double(Mask.ny());
+	}
+
+	//Weights of the cells of each slab, then compacted in slab order
+	float *weight = (float *) malloc((long) NCB*sizeof(float)); assert(weight);
+	win_start = (long *) malloc((N+1)*sizeof(long)); assert(win_start);
+
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+	#endif
+
+	#pragma omp parallel for default(shared) private(i,j,k,x2,y2,z2,x,y,z,indd,nbar_cell,inside,d,lambda,eta,indlambda,indeta) \
+	schedule(dynamic) num_threads(Nproc)
+	for(i=0;i<N;i++){
+		long ninside=0;
+		for(j=0;j<N;j++){
+			for(k=0;k<N;k++){
+				x2=i*Delta+x2min;  			y2=j*Delta+y2min;  				z2=k*Delta+z2min;
+				inside=false;
+				
+				if(Use_Mask)
+				{
+					x=(x2-y2)/sqrt(2.0); 		y=(x2+y2)/sqrt(2.0);   			z=z2;
+					d=sqrt(x*x+y*y+z*z);
+					if(y>0) lambda=-asin(x/d); 
+					if(y<=0) lambda=M_PI+asin(x/d);
+					eta=asin(z/(d*cos(lambda)));
+					lambda*=r2d; 				eta*=r2d;
+					
+					if(lambda>180.0) 
+						lambda-=360.0;
+					
+					indlambda=floor((lambda+180.0)/dlambda);
+					indeta=floor((eta+90.0)/deta);
+				
+					if( (Mask(indlambda,indeta)==1) && (d>=dmin) && (d<=dmax) ) inside=true;
+				}
+				else
+				{
+					d=sqrt(x2*x2+y2*y2+z2*z2);
+					inside=true;
+				}
+				
+				//nbar is only used without density table
+				nbar_cell=0;
+				if(inside && !Use_Density) nbar_cell=nbar;
+				if(inside && Use_Density)
+				{
+					indd=floor((d-dmin)/deltad);
+					if(indd<0 || indd>=ndens) 
+						nbar_cell=0;
+					else
+						nbar_cell=denstab[indd];
+				}
+				weight[(long) N*N*i+N*j+k]=nbar_cell*DCB;
+				if(weight[(long) N*N*i+N*j+k]>0) ninside++;
+			}
+		}
+		win_start[i+1]=ninside;
+	}
+
+	win_start[0]=0;
+	for(i=0;i<N;i++) win_start[i+1]+=win_start[i];
+	win_cell = (int *) malloc((win_start[N]+1)*sizeof(int)); assert(win_cell);
+	win_weight = (float *) malloc((win_start[N]+1)*sizeof(float)); assert(win_weight);
+
+	#pragma omp parallel for default(shared) private(i,j) num_threads(Nproc)
+	for(i=0;i<N;i++){
+		long l=win_start[i];
+		for(j=0;j<N*N;j++)
+			if(weight[(long) N*N*i+j]>0)
+			{
+				win_cell[l]=j;
+				win_weight[l]=weight[(long) N*N*i+j];
+				l++;
+			}
+	}
+	free(weight);
+
+	if(Verbose) printf("Survey window: %ld cells out of %d inside the footprint\n", win_start[N], NCB);
+}
+
+void free_window()
+{
+	free(win_start); free(win_cell); free(win_weight);
+}
+
+long sample_catalogue(fltarray &dens_array, FILE *outcatalogue, vector<float> *Points)
+{
+	//Each slab i is sampled with its own random stream and its galaxies are formatted in the
+	//buffer of the thread, buffers are written in slab order (ordered loop)
+	int i,j,k,n;
+	long l;
+	double shift_x,shift_y,shift_z;
+	double x2,y2,z2;
+	double x,y,z;
+	long int Ngal=0;
+
+	if(outcatalogue!=NULL) fprintf(outcatalogue, "x  y  z \n");
+
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+	#endif
+
+	#pragma omp parallel default(shared) private(i,j,k,n,l,shift_x,shift_y,shift_z,x2,y2,z2,x,y,z) \
+	reduction(+:Ngal) num_threads(Nproc)
+	{
+		RandStream R;
+		string buffer;
+		vector<float> points;
+		char line[128];
+		
+		#pragma omp for ordered schedule(static,1)
+		for(i=0;i<N;i++){
+			R.init(seed, stream_id(STREAM_SAMPLING,i));
+			buffer.clear();
+			points.clear();
+			for(l=win_start[i];l<win_start[i+1];l++){
+				j=win_cell[l]/N;
+				k=win_cell[l]%N;
+				n=(int) poidev(win_weight[l]*dens_array(i,j,k),R);
+				while(n>0)
+				{
+					shift_x=R.uniform(); 	shift_y=R.uniform();  shift_z=R.uniform();
+					
+					x2=(i+shift_x)*Delta+x2min; y2=(j+shift_y)*Delta+y2min; z2=(k+shift_z)*Delta+z2min;
+					if(Use_Mask)
+					{
+						x=(x2-y2)/sqrt(2.0); y=(x2+y2)/sqrt(2.0); z=z2;
+					}
+					else
+					{
+						x=x2; y=y2; z=z2;
+					}
+					if(outcatalogue!=NULL)
+					{
+						sprintf(line, "%f  %f  %f \n",x,y,z);
+						buffer.append(line);
+					}
+					if(Points!=NULL)
+					{
+						points.push_back(x); points.push_back(y); points.push_back(z);
+					}
+					Ngal++;
+					n--;
+				}
+			}
+			#pragma omp ordered
+			{
+				if(outcatalogue!=NULL) fwrite(buffer.data(), 1, buffer.size(), outcatalogue);
+				if(Points!=NULL) Points->insert(Points->end(), points.begin(), points.end());
+			}
+		}	
+	}
+	return Ngal;
+}
+
+/*************************************************/
+
+//Integral of |cos(lambda)| from 0 to lambda, for lambda in [-pi,pi]
+static double int_abs_cos(double lambda)
+{
+	if(lambda>M_PI/2.) return 2.-sin(lambda);
+	if(lambda<-M_PI/2.) return -2.-sin(lambda);
+	return sin(lambda);
+}
+
+//Inverse of int_abs_cos
+static double inv_int_abs_cos(double t)
+{
+	if(t>1.) return M_PI-asin(2.-t);
+	if(t<-1.) return -M_PI-asin(-2.-t);
+	return asin(t);
+}
+
+//First index i with cdf[i]>u (cdf is increasing and cdf[n-1]=1)
+static long search_cdf(double *cdf, long n, double u)
+{
+	long imin=0, imax=n-1, i;
+	while(imin<imax)
+	{
+		i=(imin+imax)/2;
+		if(cdf[i]<=u) imin=i+1;
+		else imax=i;
+	}
+	return imin;
+}
+
+void init_random_sampler()
+{
+	int i,j,l;
+	double x2,y2,z2,d;
+
+	//Range of distances of the points of the box
+	double dbox_min, dbox_max=0;
+	double xc,yc,zc;
+	xc = (x2min>0) ? x2min : ((x2min+L<0) ? x2min+L : 0);
+	yc = (y2min>0) ? y2min : ((y2min+L<0) ? y2min+L : 0);
+	zc = (z2min>0) ? z2min : ((z2min+L<0) ? z2min+L : 0);
+	dbox_min=sqrt(xc*xc+yc*yc+zc*zc);
+	for(l=0;l<8;l++)
+	{
+		x2=x2min+L*(l&1); y2=y2min+L*((l>>1)&1); z2=z2min+L*((l>>2)&1);
+		d=sqrt(x2*x2+y2*y2+z2*z2);
+		if(d>dbox_max) dbox_max=d;
+	}
+
+	//Radial bins of nbar(d) (one bin if nbar is constant) cut to the distances of the box,
+	//each weighted by nbar*(d_hi^3-d_lo^3)/3
+	rand_nbin = Use_Density ? ndens : 1;
+	rand_dlo = (double *) malloc(rand_nbin*sizeof(double)); assert(rand_dlo);
+	rand_dhi = (double *) malloc(rand_nbin*sizeof(double)); assert(rand_dhi);
+	rand_bin_cdf = (double *) malloc(rand_nbin*sizeof(double)); assert(rand_bin_cdf);
+	double deltad = Use_Density ? (rtab[ndens-1]-rtab[0])/double(ndens-1.0) : 0;
+	double radial=0;
+	for(i=0;i<rand_nbin;i++)
+	{
+		double dlo = Use_Density ? rtab[0]-deltad/2.0+i*deltad : 0;
+		double dhi = Use_Density ? dlo+deltad : dbox_max;
+		double n_bin = Use_Density ? denstab[i] : nbar;
+		if(dlo<dbox_min) dlo=dbox_min;
+		if(dhi>dbox_max) dhi=dbox_max;
+		if(dhi<dlo || n_bin<0) dhi=dlo;
+		rand_dlo[i]=dlo; rand_dhi[i]=dhi;
+		radial += n_bin*(dhi*dhi*dhi-dlo*dlo*dlo)/3.;
+		rand_bin_cdf[i]=radial;
+	}
+	if(radial<=0)
+	{
+		fprintf(stderr, "Error: the radial selection does not intersect the box!\n");
+		exit(-1);
+	}
+	for(i=0;i<rand_nbin;i++) rand_bin_cdf[i]/=radial;
+
+	//Solid angle of the mask pixels, dOmega = |cos(lambda)| dlambda deta
+	double angular=4*M_PI;
+	if(Use_Mask)
+	{
+		fltarray Mask;
+		fits_read_fltarr(Name_Mask,Mask);
+		rand_dlambda=2*M_PI/double(Mask.nx());
+		rand_deta=M_PI/double(Mask.ny());
+		rand_neta=Mask.ny();
+		rand_npix=0;
+		for(i=0;i<Mask.nx();i++)
+			for(j=0;j<Mask.ny();j++)
+				if(Mask(i,j)==1) rand_npix++;
+		if(rand_npix==0)
+		{
+			fprintf(stderr, "Error: empty mask %s!\n", Name_Mask);
+			exit(-1);
+		}
+		rand_pix = (int *) malloc(rand_npix*sizeof(int)); assert(rand_pix);
+		rand_pix_cdf = (double *) malloc(rand_npix*sizeof(double)); assert(rand_pix_cdf);
+		angular=0;
+		long p=0;
+		for(i=0;i<Mask.nx();i++)
+			for(j=0;j<Mask.ny();j++)
+				if(Mask(i,j)==1)
+				{
+					double lambda1=i*rand_dlambda-M_PI;
+					angular += (int_abs_cos(lambda1+rand_dlambda)-int_abs_cos(lambda1))*rand_deta;
+					rand_pix[p]=i*rand_neta+j;
+					rand_pix_cdf[p]=angular;
+					p++;
+				}
+		for(p=0;p<rand_npix;p++) rand_pix_cdf[p]/=angular;
+		rand_pix_cdf[rand_npix-1]=1.;
+	}
+	rand_bin_cdf[rand_nbin-1]=1.;
+
+	rand_mean = angular*radial;
+	if(Verbose) printf("Random catalogue: %f points expected in the window before the cut by the box\n", rand_mean);
+}
+
+void free_random_sampler()
+{
+	free(rand_dlo); free(rand_dhi); free(rand_bin_cdf);
+	if(Use_Mask) {free(rand_pix); free(rand_pix_cdf);}
+}
+
+long sample_random(FILE *outcatalogue, vector<float> *Points)
+{
+	//The total number of points is Poisson, the points are drawn in chunks of RANDOM_CHUNK,
+	//each with its own random stream, and written in chunk order
+	long c,l,nc;
+	int b;
+	double d,u,lambda,eta,mu,phi;
+	double x2,y2,z2;
+	double x,y,z;
+	long int Ngal=0;
+
+	RandStream R0(seed, stream_id(STREAM_RANDOM_TOTAL,0));
+	long Ntot=(long) poidev(rand_mean,R0);
+	long Nchunk=(Ntot+RANDOM_CHUNK-1)/RANDOM_CHUNK;
+
+	if(outcatalogue!=NULL) fprintf(outcatalogue, "x  y  z \n");
+
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+	#endif
+
+	#pragma omp parallel default(shared) private(c,l,nc,b,d,u,lambda,eta,mu,phi,x2,y2,z2,x,y,z) \
+	reduction(+:Ngal) num_threads(Nproc)
+	{
+		RandStream R;
+		string buffer;
+		vector<float> points;
+		char line[128];
+
+		#pragma omp for ordered schedule(static,1)
+		for(c=0;c<Nchunk;c++){
+			R.init(seed, stream_id(STREAM_RANDOM_POINTS,c));
+			buffer.clear();
+			points.clear();
+			nc = (c<Nchunk-1) ? RANDOM_CHUNK : Ntot-c*RANDOM_CHUNK;
+			for(l=0;l<nc;l++){
+				//distance: radial bin, then d^3 uniform in the bin
+				b=search_cdf(rand_bin_cdf,rand_nbin,R.uniform());
+				u=R.uniform();
+				d=pow(rand_dlo[b]*rand_dlo[b]*rand_dlo[b]*(1-u)+rand_dhi[b]*rand_dhi[b]*rand_dhi[b]*u, 1./3.);
+
+				if(Use_Mask)
+				{
+					//direction: mask pixel, then uniform in solid angle inside the pixel
+					long p=rand_pix[search_cdf(rand_pix_cdf,rand_npix,R.uniform())];
+					double lambda1=(p/rand_neta)*rand_dlambda-M_PI;
+					double t1=int_abs_cos(lambda1), t2=int_abs_cos(lambda1+rand_dlambda);
+					lambda=inv_int_abs_cos(t1+(t2-t1)*R.uniform());
+					eta=((p%rand_neta)+R.uniform())*rand_deta-M_PI/2.;
+
+					x=-d*sin(lambda); y=d*cos(lambda)*cos(eta); z=d*cos(lambda)*sin(eta);
+					x2=(x+y)/sqrt(2.0); y2=(y-x)/sqrt(2.0); z2=z;
+				}
+				else
+				{
+					mu=2*R.uniform()-1; phi=2*M_PI*R.uniform();
+					x2=d*sqrt(1-mu*mu)*cos(phi); y2=d*sqrt(1-mu*mu)*sin(phi); z2=d*mu;
+					x=x2; y=y2; z=z2;
+				}
+
+				if(x2<x2min || x2>=x2min+L || y2<y2min || y2>=y2min+L || z2<z2min || z2>=z2min+L) continue;
+				if(outcatalogue!=NULL)
+				{
+					sprintf(line, "%f  %f  %f \n",x,y,z);
+					buffer.append(line);
+				}
+				if(Points!=NULL)
+				{
+					points.push_back(x); points.push_back(y); points.push_back(z);
+				}
+				Ngal++;
+			}
+			#pragma omp ordered
+			{
+				if(outcatalogue!=NULL) fwrite(buffer.data(), 1, buffer.size(), outcatalogue);
+				if(Points!=NULL) Points->insert(Points->end(), points.begin(), points.end());
+			}
+		}
+	}
+	return Ngal;
+}
+
+void name_realisation(char *Name, const char *Prefix, const char *Suffix, int real, int nreal)
+{
+	//In batch mode the realisation number is inserted before the extension of the suffix
+	strcpy(Name, Prefix);
+	if(nreal==1)
+	{
+		strcat(Name, Suffix);
+		return;
+	}
+	char Temp[256];
+	const char *ext=strrchr(Suffix,'.');
+	int len = (ext==NULL) ? strlen(Suffix) : (int) (ext-Suffix);
+	strncat(Name, Suffix, len);
+	sprintf(Temp, "_%d%s", real, (ext==NULL) ? "" : ext);
+	strcat(Name, Temp);
+}
@@ -0,0 +1,245 @@
+/*******************************************************
+Program: 'rmk_catalogue.cc'
+
+Remake a catalogue created by 'lognormal' before calculating
+the correlation function as a function of alpha with 'cf_alpha',
+and create the alpha belonging of each galaxy of the output
+catalogue (see Labatie et al. 2012). This is the C++ version of
+the idl procedure idl/rmk_catalogue.pro.
+
+A uniform u is drawn for each galaxy, the galaxy belongs to the
+catalogue for a value alpha if u<selection_alpha(d) with d its
+distance. For each interval [alpha,alpha'] where the galaxy belongs
+to the catalogue, a galaxy is written in the output catalogue and
+[alpha,alpha'] in the alpha belonging file.
+
+The selection table is read once, the input catalogue is read by
+blocks and each block is processed in parallel. The u of the i-th
+galaxy is the i-th number of a counter-based random stream, so the
+output only depends on the seed. Both output files are written in
+one pass, the number of points in their header is filled at the end.
+
+Version history:
+
+  V. 0.1 (19/10/2026): Initial version.
+
+  V. 0.2 (19/10/2026): The selection and the alpha transitions are
+         in 'rmk_catalogue_obj.cc', shared with 'lognormal_cf_alpha'.
+
+  V. 0.3 (19/10/2026): The default seed also depends on the process
+         id, so that calls started in the same second (data and random
+         catalogues) do not draw the same uniforms.
+********************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <ctime>
+#include <unistd.h>
+#include "Array.h"
+#include "IM_IO.h"
+#include "RandStream.h"
+#include "rmk_catalogue.h"
+#include <omp.h>
+
+#define BLOCK 1048576       //number of galaxies read at once
+#define CHUNK 4096          //number of galaxies processed by a thread at once
+#define NHEAD 16            //width of the number of points in the output headers
+
+bool Verbose = false;
+long seed;
+
+char Name_Cat_In[256];
+char Name_Cat_Out[256];
+char Name_Alpha_Out[256];
+
+//maximum number of procs used for the loops
+int Nproc_max=40;
+
+
+/***************************************************************************/
+
+static void usage(char *argv[])
+{
+
+  fprintf(stderr, "Usage: %s options in_Catalogue_file out_Catalogue_file out_Alpha_file\n\n", argv[0]);
+  fprintf(stderr, "   where options = \n");
+
+  fprintf(stderr, "         [-I InitRandomVal]\n");
+  fprintf(stderr, "             Value used for random value generator initialization.\n");
+  fprintf(stderr, "             Default is the time and the process id, give a different\n");
+  fprintf(stderr, "             value to each call for reproducible catalogues.\n\n");
+
+  fprintf(stderr, "         [-v]\n");
+  fprintf(stderr, "             Verbose.\n\n");
+
+
+  fprintf(stderr, "\n");
+  exit(-1);
+}
+
+
+void get_args(int argc, char *argv[])
+{
+
+  /* Require arguments (need at least one) !! */
+  if(argc == 1){
+    usage(argv);
+  }
+  /* Start at i = 1 to skip the command name. */
+  int i=1;
+
+    /* Check for a switch (leading "-"). */
+
+  while(argv[i][0] == '-') {
+
+      /* Use the next character to decide what to do. */
+
+    switch (argv[i][1]) {
+
+    case 'I':
+      seed = atol(argv[++i]);
+      break;
+
+    case 'v': Verbose = true;
+      break;
+
+    case '?': usage(argv);
+      break;
+
+    default:  usage(argv);
+      break;
+    }
+    i++;
+	if(i==argc) usage(argv);
+  }
+
+  if(i<(argc)-2){
+      strcpy(Name_Cat_In, argv[i++]);
+      strcpy(Name_Cat_Out, argv[i++]);
+      strcpy(Name_Alpha_Out, argv[i++]);
+  }
+  else usage(argv);
+
+  if(i < argc){
+    fprintf(stderr, "Too many parameters: %s ...\n", argv[i]);
+    usage(argv);
+  }
+
+}
+
+/*********************************************************************/
+
+
+//Read at most nmax galaxies of the lognormal catalogue, return the number read
+long read_block(FILE *in, float *x, float *y, float *z, long nmax)
+{
+	char line[256];
+	long n=0;
+	while(n<nmax && fgets(line, 256, in)!=NULL)
+		if(sscanf(line, "%f %f %f", x+n, y+n, z+n)==3) n++;     //skips the header line "x  y  z"
+	return n;
+}
+
+int main(int argc, char ** argv)
+{
+	//default seed: the pid separates the calls started in the same second
+	seed = (long) time(NULL) ^ ((long) getpid() << 16);
+	get_param_selection();
+	get_args(argc,argv);
+
+	if(Verbose)
+	{
+		printf("\n\n# PARAMETERS: \n\n");
+		printf("# Input catalogue = %s\n", Name_Cat_In);
+		printf("# Output catalogue = %s\n", Name_Cat_Out);
+		printf("# Output alpha belonging = %s\n", Name_Alpha_Out);
+		printf("# Selection = %s\n", Name_Selection);
+		printf("# alpha = %f .. %f, nalpha = %d\n\n", alpha_min, alpha_max, nalpha);
+	}
+
+	init_selection();
+	double d_alpha=(alpha_max-alpha_min)/double(nalpha-1.0);
+
+	FILE *in=fopen(Name_Cat_In, "r");
+	if(in==NULL)
+	{
+		cerr << "Error: cannot open file " << Name_Cat_In << endl;
+		exit(-1);
+	}
+	FILE *out=fopen(Name_Cat_Out, "w"); assert(out);
+	FILE *out_alpha=fopen(Name_Alpha_Out, "w"); assert(out_alpha);
+
+	//header of ArrayPoint files, the number of points is written at the end
+	fprintf(out, "%*d 3 1\n0 0 0\n0 0 0\n0 0 0\n", NHEAD, 0);
+	fprintf(out_alpha, "%*d 2 1\n0 0 0\n0 0 0\n", NHEAD, 0);
+
+	float *x=(float *) malloc(BLOCK*sizeof(float)); assert(x);
+	float *y=(float *) malloc(BLOCK*sizeof(float)); assert(y);
+	float *z=(float *) malloc(BLOCK*sizeof(float)); assert(z);
+
+	#ifdef _OPENMP
+		int Nproc=omp_get_num_procs();
+		if(Nproc>Nproc_max) Nproc=Nproc_max;
+		if(Verbose) printf("\n %u processors used for the loop \n\n",Nproc);
+	#endif
+
+	long n_in=0, n_out=0, n;
+	while((n=read_block(in, x, y, z, BLOCK))>0)
+	{
+		long c, i, nout_block=0;
+		#pragma omp parallel default(shared) private(c,i) reduction(+:nout_block) num_threads(Nproc)
+		{
+			RandStream R(seed, 0);
+			string buffer, buffer_alpha;
+			char line[128];
+			int *l=(int *) malloc((nalpha+2)*sizeof(int));
+			int nl, j;
+			double d;
+
+			#pragma omp for ordered schedule(static,1)
+			for(c=0;c<n;c+=CHUNK){
+				buffer.clear(); buffer_alpha.clear();
+				for(i=c;i<n && i<c+CHUNK;i++){
+					d=sqrt((double) x[i]*x[i]+(double) y[i]*y[i]+(double) z[i]*z[i]);
+
+					//u of the galaxy n_in+i of the input catalogue
+					R.set_counter(n_in+i);
+					nl=alpha_transitions(d, R.uniform(), l);
+					for(j=0;j<nl;j+=2)
+					{
+						sprintf(line, "%f  %f  %f\n", x[i], y[i], z[i]);
+						buffer.append(line);
+						sprintf(line, "%f  %f\n", alpha_min+d_alpha*l[j], alpha_min+d_alpha*l[j+1]);
+						buffer_alpha.append(line);
+						nout_block++;
+					}
+				}
+				#pragma omp ordered
+				{
+					fwrite(buffer.data(), 1, buffer.size(), out);
+					fwrite(buffer_alpha.data(), 1, buffer_alpha.size(), out_alpha);
+				}
+			}
+			free(l);
+		}
+		n_in+=n;
+		n_out+=nout_block;
+	}
+	fclose(in);
+
+	//number of points in the headers
+	fseek(out, 0, SEEK_SET);
+	fprintf(out, "%*ld", NHEAD, n_out);
+	fseek(out_alpha, 0, SEEK_SET);
+	fprintf(out_alpha, "%*ld", NHEAD, n_out);
+	fclose(out);
+	fclose(out_alpha);
+
+	free(x); free(y); free(z);
+
+	printf("N_galaxies in= %li, out= %li\n", n_in, n_out);
+	exit(0);
+}
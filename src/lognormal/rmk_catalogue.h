@@ -0,0 +1,36 @@
+/***********************************************************
+**
+**    File:  	rmk_catalogue.h
+**
+************************************************************
+**
+**  Selection function as a function of alpha and alpha
+**  belonging of the galaxies (see Labatie et al. 2012),
+**  used by 'rmk_catalogue' and 'lognormal_cf_alpha'
+**
+************************************************************/
+
+
+#ifndef	_RMK_CATALOGUE_H_
+#define	_RMK_CATALOGUE_H_
+
+#include "Array.h"
+
+//parameters set in rmk_catalogue.param
+extern char Name_Selection[256];
+extern double alpha_min;
+extern double alpha_max;
+extern int nalpha;
+
+//selection table: r in column 0, selection for alpha index a in column 1+a
+extern fltarray Selection;
+
+void get_param_selection();
+void init_selection();           //read the selection table and set its r binning
+
+//Indices l[0..nl-1] of the alpha transitions of a galaxy at distance d with uniform u,
+//the galaxy belongs to the catalogue for alpha indices in [l[2j],l[2j+1]).
+//l must have nalpha+2 elements, return nl
+int alpha_transitions(double d, double u, int *l);
+
+#endif
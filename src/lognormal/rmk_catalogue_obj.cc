@@ -0,0 +1,82 @@
+/*******************************************************
+File: 'rmk_catalogue_obj.cc'
+
+Selection function as a function of alpha and alpha belonging
+of the galaxies, shared by the programs 'rmk_catalogue' and
+'lognormal_cf_alpha'. See 'rmk_catalogue.cc' and
+idl/rmk_catalogue.pro.
+********************************************************/
+
+#include <cstdlib>
+#include <cmath>
+#include "Array.h"
+#include "IM_IO.h"
+#include "rmk_catalogue.h"
+
+//parameters to be set in rmk_catalogue.param
+char Name_Selection[256];
+double alpha_min;
+double alpha_max;
+int nalpha;
+
+fltarray Selection;
+int sel_nr;
+double sel_rmin, sel_dr;
+
+
+/* GET PARAMETERS */
+
+void get_param_selection()
+{
+	char Name_Param_File[256];
+	sprintf(Name_Param_File, "../param/rmk_catalogue.param");
+	FILE *File=fopen(Name_Param_File,"r");
+
+    if (File == NULL)
+    {
+		cerr << "Error: cannot open file "  <<  Name_Param_File << endl;
+		exit(-1);
+    }
+	char Temp[256];
+	int ret;
+	ret=fscanf(File, "%s\t%s\n", Temp, Name_Selection);	//fits file of the selection: r in column 0, selection for each alpha in columns 1..nalpha
+	ret=fscanf(File, "%s\t%lf\n", Temp, &alpha_min);
+	ret=fscanf(File, "%s\t%lf\n", Temp, &alpha_max);
+	ret=fscanf(File, "%s\t%i\n", Temp, &nalpha);
+
+	fclose(File);
+
+}
+
+/*********************************************************************/
+
+void init_selection()
+{
+	//selection function as a function of alpha, r binning in column 0
+	fits_read_fltarr(Name_Selection, Selection);
+	sel_nr=Selection.nx();
+	if(Selection.ny()<nalpha+1)
+	{
+		fprintf(stderr, "Error: %s has %d alpha columns, %d needed!\n", Name_Selection, Selection.ny()-1, nalpha);
+		exit(-1);
+	}
+	sel_dr=(Selection(sel_nr-1,0)-Selection(0,0))/double(sel_nr-1.0);
+	sel_rmin=Selection(0,0)-sel_dr/2.0;
+}
+
+/*********************************************************************/
+
+int alpha_transitions(double d, double u, int *l)
+{
+	int a, nl=0;
+	int indr=floor((d-sel_rmin)/sel_dr);
+	if(indr<0) indr=0;
+	if(indr>=sel_nr) indr=sel_nr-1;
+
+	//transitions in->out and out->in of the catalogue between alpha indices a-1 and a
+	if(Selection(indr,1)>u) l[nl++]=0;
+	for(a=1;a<nalpha;a++)
+		if( (Selection(indr,a)>u) != (Selection(indr,a+1)>u) ) l[nl++]=a;
+	if(nl%2==1) l[nl++]=nalpha;
+	return nl;
+}